@@ -0,0 +1,154 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <ctime>
+#include <cstdlib>
+#include <cstddef>
+
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "byte.h"
+#include "video/synthetic_source.h"
+#include "video/jpeg_encoder.h"
+#include "sock/server_socket.h"
+#include "pipeline/pipeline.h"
+#include "pipeline/rtp_egress.h"
+#include "pipeline/rtp_sink.h"
+#include "pipeline/frame_packetizer.h"
+#include "pipeline/rtp_streamer.h"
+
+namespace {
+
+const unsigned int kWidth = 1280;
+const unsigned int kHeight = 960;
+const int kQuality = 70;
+//! Different frames encoded before measuring
+const std::size_t kEncodedFrames = 10;
+//! Frames sent for every packet size
+const std::size_t kSentFrames = 500;
+//! Local port, RTP is sent from
+const int kSenderPort = 6990;
+//! Local port, RTP is sent to
+const int kReceiverPort = 6992;
+//! Measured sizes of RTP packets
+const std::size_t kBytesPerPacket[] = {512, 1000, 1400, 4000, 8000, 16000, 32000};
+
+/**
+ * @brief Get CPU time consumed by the calling thread
+ *
+ * @return CPU time
+ */
+std::chrono::nanoseconds GetThreadCpuTime() {
+  timespec time = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+/**
+ * @brief Encode frames of the synthetic source
+ * @details Frame rate is high, so the source doesn't hold encoding
+ *
+ * @return Encoded frames
+ */
+std::vector<pipeline::EncodedFramePtr> EncodeFrames() {
+  video::SyntheticSource source(kWidth, kHeight, 1000);
+  video::JpegEncoder encoder(kWidth, kHeight, kQuality);
+  Bytes raw_frame(source.GetFrameSize());
+
+  std::vector<pipeline::EncodedFramePtr> frames;
+  for (std::size_t i = 0; i < kEncodedFrames; ++i) {
+    source.Grab(raw_frame.data());
+    auto frame = std::make_shared<pipeline::EncodedFrame>();
+    encoder.Encode(raw_frame.data(), frame->jpeg);
+    frame->width = kWidth;
+    frame->height = kHeight;
+    frame->quality = kQuality;
+    frame->number = i;
+    frame->capture_time = std::chrono::steady_clock::now();
+    frames.push_back(std::move(frame));
+  }
+
+  return frames;
+}
+
+} // namespace
+
+/**
+ * @brief Measure packets per frame and CPU time per frame of the send stage
+ * for different RTP packet sizes
+ * @details Frames are sent without pacing through the egress to loopback,
+ * so only packetization and system calls are measured
+ */
+int main() {
+  const std::vector<pipeline::EncodedFramePtr> frames = EncodeFrames();
+  std::size_t total_size = 0;
+  for (const pipeline::EncodedFramePtr &frame : frames) {
+    total_size += frame->jpeg.size();
+  }
+  std::cout << "Average frame size: " << total_size / frames.size() << " bytes\n"
+            << std::endl;
+
+  // Datagrams aren't read, receiver only keeps the port open, so kernel
+  // doesn't answer with ICMP port unreachable
+  sock::ServerSocket receiver(sock::Type::kUdp, kReceiverPort);
+  const auto egress = std::make_shared<pipeline::RtpEgress>(
+      pipeline::RtpEgress::Config{false, kSenderPort, {"", 1}});
+  const auto packetizer = std::make_shared<pipeline::FramePacketizer>();
+
+  std::cout << std::left << std::setw(14) << "bytes/packet" << std::setw(16)
+            << "packets/frame" << "CPU us/frame" << std::endl;
+
+  for (const std::size_t bytes_per_packet : kBytesPerPacket) {
+    const pipeline::StreamConfig config = {
+        bytes_per_packet,
+        std::chrono::milliseconds(100), // frame_interval
+        0, // pacing_fraction
+        3, // max_queued_frames
+        0, // history_frames
+        0 // max_retransmits_per_frame
+    };
+    pipeline::RtpStreamer streamer(
+        config, packetizer,
+        std::make_unique<pipeline::UdpSink>("127.0.0.1", kReceiverPort, egress));
+
+    const std::chrono::nanoseconds start = GetThreadCpuTime();
+    for (std::size_t i = 0; i < kSentFrames; ++i) {
+      streamer.OnFrame(frames[i % frames.size()]);
+      streamer.Flush();
+    }
+    const std::chrono::nanoseconds cpu_time = GetThreadCpuTime() - start;
+
+    std::cout << std::left << std::fixed << std::setprecision(1)
+              << std::setw(14) << bytes_per_packet
+              << std::setw(16) << static_cast<double>(streamer.GetPacketCount()) / kSentFrames
+              << std::chrono::duration<double, std::micro>(cpu_time).count() / kSentFrames
+              << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cctype>
+#include <cstdlib>
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "rtsp/request.h"
+#include "rtsp/request_parser.h"
+
+namespace {
+
+//! Requests of a usual session
+const std::vector<std::string> kRequests = {
+    "OPTIONS rtsp://192.168.1.10:5544/jpeg RTSP/1.0\r\n"
+    "CSeq: 1\r\n"
+    "User-Agent: LibVLC/3.0.16 (LIVE555 Streaming Media v2021.08.24)\r\n"
+    "\r\n",
+    "DESCRIBE rtsp://192.168.1.10:5544/jpeg RTSP/1.0\r\n"
+    "CSeq: 2\r\n"
+    "User-Agent: LibVLC/3.0.16 (LIVE555 Streaming Media v2021.08.24)\r\n"
+    "Accept: application/sdp\r\n"
+    "\r\n",
+    "SETUP rtsp://192.168.1.10:5544/jpeg/track1 RTSP/1.0\r\n"
+    "CSeq: 3\r\n"
+    "User-Agent: LibVLC/3.0.16 (LIVE555 Streaming Media v2021.08.24)\r\n"
+    "Transport: RTP/AVP;unicast;client_port=50000-50001\r\n"
+    "Blocksize: 1400\r\n"
+    "\r\n",
+    "PLAY rtsp://192.168.1.10:5544/jpeg RTSP/1.0\r\n"
+    "CSeq: 4\r\n"
+    "User-Agent: LibVLC/3.0.16 (LIVE555 Streaming Media v2021.08.24)\r\n"
+    "Session: 12345678\r\n"
+    "Range: npt=0.000-\r\n"
+    "\r\n",
+    "GET_PARAMETER rtsp://192.168.1.10:5544/jpeg RTSP/1.0\r\n"
+    "CSeq: 5\r\n"
+    "User-Agent: LibVLC/3.0.16 (LIVE555 Streaming Media v2021.08.24)\r\n"
+    "Session: 12345678\r\n"
+    "Content-Type: text/parameters\r\n"
+    "Content-Length: 26\r\n"
+    "\r\n"
+    "packet_count\r\n"
+    "jitter_ms\r\n"
+};
+
+//! Number of parsed requests per measurement
+const std::size_t kIterations = 200'000;
+
+/**
+ * @brief Headers of the request as they were stored before RequestParser
+ * @details Hasher and comparator took strings by value and lowered them
+ */
+struct LegacyHeaderNameHash {
+  std::size_t operator()(std::string header_name) const {
+    std::transform(header_name.begin(), header_name.end(), header_name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return std::hash<std::string>()(header_name);
+  }
+};
+
+struct LegacyHeaderNameEqual {
+  bool operator()(std::string lhs, std::string rhs) const {
+    return LegacyHeaderNameHash()(std::move(lhs)) == LegacyHeaderNameHash()(std::move(rhs));
+  }
+};
+
+/**
+ * @brief Request as it was parsed before RequestParser
+ */
+struct LegacyRequest {
+  using Headers = std::unordered_map<std::string, std::string,
+                                     LegacyHeaderNameHash, LegacyHeaderNameEqual>;
+
+  std::string method;
+  std::string url;
+  float version;
+  Headers headers;
+  std::string body;
+};
+
+/**
+ * @brief Parse request the way it was done before RequestParser
+ * @details Data is appended in chunks and the whole buffer is searched for
+ * the end of headers after every chunk. Then everything is copied through
+ * std::istringstream
+ *
+ * @param data Request bytes
+ * @param chunk_size Number of bytes arriving at once
+ * @return Parsed request
+ */
+LegacyRequest LegacyParse(std::string_view data, const std::size_t chunk_size) {
+  std::string request_str;
+  std::size_t offset = 0;
+  while (request_str.rfind("\r\n\r\n") == std::string::npos && offset < data.size()) {
+    request_str += std::string(data.substr(offset, chunk_size));
+    offset += chunk_size;
+  }
+
+  LegacyRequest request;
+  std::istringstream iss(std::move(request_str));
+  iss >> request.method >> request.url;
+  iss.ignore(1);
+  std::string protocol;
+  std::getline(iss, protocol, '/');
+  iss >> request.version;
+  iss.ignore(2, '\n');
+
+  std::string line;
+  while (std::getline(iss, line) && line != "\r") {
+    std::istringstream header_iss(line);
+    std::string header_name;
+    std::string header_value;
+    std::getline(header_iss, header_name, ':');
+    header_iss.ignore(1);
+    std::getline(header_iss, header_value, '\r');
+    request.headers.insert({header_name, header_value});
+  }
+  request.body = iss.str().substr(iss.tellg());
+
+  // Body was read separately, until Content-Length bytes were received
+  auto it = request.headers.find("Content-Length");
+  const std::size_t content_length = (it != request.headers.end() ?
+                                      std::stoul(it->second) : 0);
+  while (request.body.size() < content_length && offset < data.size()) {
+    request.body += std::string(data.substr(offset, chunk_size));
+    offset += chunk_size;
+  }
+
+  return request;
+}
+
+/**
+ * @brief Parse request with RequestParser and convert it to rtsp::Request
+ * @details Data is appended to the connection buffer in chunks and parser
+ * resumes after every chunk
+ *
+ * @param data Request bytes
+ * @param chunk_size Number of bytes arriving at once
+ * @param parser Parser of the connection
+ * @param buffer Input buffer of the connection
+ * @param view Parsed request view
+ * @return Parsed request
+ */
+rtsp::Request Parse(std::string_view data, const std::size_t chunk_size,
+                    rtsp::RequestParser &parser, std::string &buffer,
+                    rtsp::RequestView &view) {
+  buffer.clear();
+  for (std::size_t offset = 0; offset < data.size(); offset += chunk_size) {
+    buffer.append(data.substr(offset, chunk_size));
+    if (parser.Parse(buffer, view) != 0) {
+      break;
+    }
+  }
+
+  return rtsp::ToRequest(view);
+}
+
+/**
+ * @brief Measure number of requests parsed per second
+ *
+ * @param parse Function parsing one request
+ * @return Requests per second
+ */
+double Measure(const std::function<std::size_t(std::string_view)> &parse) {
+  std::size_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < kIterations; ++i) {
+    checksum += parse(kRequests[i % kRequests.size()]);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  // Result is used, so parsing is not optimized out
+  if (checksum == 0) {
+    std::cerr << "Nothing was parsed" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  return kIterations / elapsed.count();
+}
+
+} // namespace
+
+/**
+ * @brief Compare requests per second of RequestParser with the parser it
+ * replaced, when requests arrive whole or in small pieces
+ */
+int main() {
+  std::cout << std::left << std::setw(10) << "chunk" << std::setw(18) << "legacy req/s"
+            << std::setw(18) << "parser req/s" << "speedup" << std::endl;
+
+  for (const std::size_t chunk_size : {std::size_t(1024), std::size_t(16)}) {
+    const double legacy = Measure([chunk_size](std::string_view data) {
+      return LegacyParse(data, chunk_size).headers.size();
+    });
+
+    rtsp::RequestParser parser;
+    std::string buffer;
+    rtsp::RequestView view;
+    const double current = Measure([&](std::string_view data) {
+      return Parse(data, chunk_size, parser, buffer, view).headers.Size();
+    });
+
+    std::cout << std::left << std::fixed << std::setprecision(0)
+              << std::setw(10) << chunk_size << std::setw(18) << legacy
+              << std::setw(18) << current << std::setprecision(1)
+              << current / legacy << "x" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
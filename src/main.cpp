@@ -23,96 +23,229 @@ SOFTWARE.
 */
 
 #include <cstdlib>
+#include <cstdint>
 #include <csignal>
 
 #include <iostream>
-#include <vector>
-#include <future>
+#include <string>
+#include <stdexcept>
+#include <optional>
+#include <chrono>
 
-#include "camera.h"
+#include "video/frame_source.h"
+#include "video/synthetic_source.h"
+#include "video/file_source.h"
+#ifdef WITH_RASPICAM
+#include "video/raspicam_source.h"
+#endif
 #include "sock/server_socket.h"
-#include "sock/exception.h"
+#include "sock/reactor.h"
 #include "processing/request_dispatcher.h"
+#include "processing/client_handler.h"
 #include "processing/servlets/jpeg.h"
 
 namespace {
 
-volatile bool stop_flag = false;
+const char kUsage[] =
+    "Usage: pi-rtsp-server [--kernel-pacing] [--zerocopy]"
+    " [--multicast GROUP:PORT[/TTL][@IFACE]]"
+    " [camera | synthetic [WIDTHxHEIGHT] [FPS] |"
+    " file Y4M_PATH | file RGB_PATH WIDTHxHEIGHT [FPS]]";
 
-void SignalHandler(int) {
-  stop_flag = true;
-}
+//! Option to pace datagrams by kernel (SO_TXTIME) instead of sleeping
+const char kKernelPacingOption[] = "--kernel-pacing";
+//! Option to send frames interleaved into RTSP connections with MSG_ZEROCOPY.
+//! Pays off for large frames on real network interfaces
+const char kZeroCopyOption[] = "--zerocopy";
+//! Option to enable multicast stream to the given group
+const char kMulticastOption[] = "--multicast";
 
-processing::RequestDispatcher BuildRequestDispatcher() {
-  processing::RequestDispatcher request_dispatcher;
+/**
+ * @brief Options of the server, which go before the frame source arguments
+ */
+struct Options {
+  bool kernel_pacing; //!< If true, datagrams are paced by kernel
+  bool zero_copy; //!< If true, RTSP connections send large data with MSG_ZEROCOPY
+  //! Multicast stream or std::nullopt, if multicast is disabled
+  std::optional<processing::servlets::Jpeg::MulticastConfig> multicast;
+};
 
-  request_dispatcher.RegisterServlet(
-      "/jpeg",
-      std::make_shared<processing::servlets::Jpeg>()
-  );
+/**
+ * @brief Parse dimensions in WIDTHxHEIGHT format
+ * @throws std::invalid_argument if str has wrong format
+ *
+ * @param str String with dimensions
+ * @return Pair of width and height
+ */
+std::pair<unsigned int, unsigned int> ParseDimensions(const std::string &str) {
+  const std::size_t delimiter_pos = str.find('x');
+  if (delimiter_pos == std::string::npos) {
+    throw std::invalid_argument(kUsage);
+  }
 
-  return request_dispatcher;
+  return {static_cast<unsigned int>(std::stoul(str.substr(0, delimiter_pos))),
+          static_cast<unsigned int>(std::stoul(str.substr(delimiter_pos + 1)))};
 }
 
-void HandleClient(const processing::RequestDispatcher &dispatcher,
-                  std::shared_ptr<sock::Socket> socket_ptr) {
-  try {
-    bool close_connection = false;
-    while (!close_connection) {
-      rtsp::Response response;
-      rtsp::Request request;
-
-      try {
-        *socket_ptr >> request;
-        std::cout << "\nRequest:\n" << request << std::endl;
-        response = dispatcher.Dispatch(request);
-      } catch (const rtsp::ParseError &ex) {
-        std::cout << "Can't parse request: " << ex.what() << std::endl;
-        response = {400, "Bad Request"};
-      }
+/**
+ * @brief Parse multicast stream in GROUP:PORT[/TTL][@IFACE] format
+ * @details TTL defaults to 1, which keeps datagrams in the local network.
+ * IFACE is IP address of the interface to send from, default route is used
+ * without it
+ * @throws std::invalid_argument if str has wrong format
+ *
+ * @param str String with multicast stream
+ * @return Multicast stream configuration
+ */
+processing::servlets::Jpeg::MulticastConfig ParseMulticast(const std::string &str) {
+  const std::size_t port_pos = str.find(':');
+  const std::size_t ttl_pos = str.find('/');
+  const std::size_t interface_pos = str.find('@');
+  if (port_pos == std::string::npos || port_pos == 0) {
+    throw std::invalid_argument(kUsage);
+  }
 
-      *socket_ptr << response << std::endl;
-      std::cout << "\nResponse:\n" << response << std::endl;
-      if (request.method == rtsp::Method::kTeardown) {
-        close_connection = true;
+  processing::servlets::Jpeg::MulticastConfig config = {
+      str.substr(0, port_pos), // group
+      std::stoi(str.substr(port_pos + 1)), // port
+      {
+          (interface_pos != std::string::npos ? str.substr(interface_pos + 1) :
+                                                ""), // interface_ip
+          (ttl_pos != std::string::npos ? std::stoi(str.substr(ttl_pos + 1)) :
+                                          1) // ttl
       }
+  };
+  if (config.port <= 0 || config.port >= UINT16_MAX || config.options.ttl < 0 ||
+      config.options.ttl > UINT8_MAX) {
+    throw std::invalid_argument(kUsage);
+  }
+
+  return config;
+}
+
+/**
+ * @brief Parse options, which go before the frame source arguments
+ * @details Parsed options are removed from the arguments
+ * @throws std::invalid_argument if options are wrong
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Parsed options
+ */
+Options ParseOptions(int &argc, char **&argv) {
+  Options options = {false, false, std::nullopt};
+
+  while (argc > 1 && std::string(argv[1]).rfind("--", 0) == 0) {
+    const std::string option = argv[1];
+    if (option == kKernelPacingOption) {
+      options.kernel_pacing = true;
+    } else if (option == kZeroCopyOption) {
+      options.zero_copy = true;
+    } else if (option == kMulticastOption && argc > 2) {
+      options.multicast = ParseMulticast(argv[2]);
+      --argc;
+      ++argv;
+    } else {
+      throw std::invalid_argument(kUsage);
     }
-  } catch (const sock::ReadError &) {
-    std::cout << "Client on socket " << socket_ptr->GetDescriptor()
-              << " disconnected" << std::endl;
-  } catch (const sock::SendError &) {
-    std::cout << "Client on socket " << socket_ptr->GetDescriptor()
-              << " disconnected while was waiting for response" << std::endl;
+    --argc;
+    ++argv;
   }
-  std::cout << "Socket " << socket_ptr->GetDescriptor()
-            << " closed" << std::endl;
+
+  return options;
+}
+
+/**
+ * @brief Build frame source according to the command line arguments
+ * @details Camera is used if nothing is specified
+ * @throws std::invalid_argument if arguments are wrong
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Frame source
+ */
+std::shared_ptr<video::FrameSource> BuildFrameSource(int argc, char **argv) {
+  const unsigned int kDefaultWidth = 1280;
+  const unsigned int kDefaultHeight = 960;
+  const unsigned int kDefaultFrameRate = 10;
+
+  const std::string source_type = (argc > 1 ? argv[1] : "camera");
+  if (source_type == "camera") {
+#ifdef WITH_RASPICAM
+    return std::make_shared<video::RaspicamSource>();
+#else
+    throw std::invalid_argument("Server is built without camera support");
+#endif
+  }
+
+  if (source_type == "synthetic") {
+    const auto [width, height] = (argc > 2 ? ParseDimensions(argv[2]) :
+        std::pair(kDefaultWidth, kDefaultHeight));
+    const unsigned int frame_rate = (argc > 3 ? std::stoul(argv[3]) :
+        kDefaultFrameRate);
+    return std::make_shared<video::SyntheticSource>(width, height, frame_rate);
+  }
+
+  if (source_type == "file" && argc == 3) {
+    return std::make_shared<video::FileSource>(argv[2]);
+  }
+
+  if (source_type == "file" && argc > 3) {
+    const auto [width, height] = ParseDimensions(argv[3]);
+    const unsigned int frame_rate = (argc > 4 ? std::stoul(argv[4]) :
+        kDefaultFrameRate);
+    return std::make_shared<video::FileSource>(argv[2], width, height,
+                                               frame_rate);
+  }
+
+  throw std::invalid_argument(kUsage);
+}
+
+/**
+ * @brief Register servlets of the server
+ * @details Servlets start their threads, so signals must be blocked before
+ *
+ * @param request_dispatcher Dispatcher to register servlets in
+ * @param frame_source Source of the streamed frames
+ * @param options Options of the server
+ */
+void RegisterServlets(processing::RequestDispatcher &request_dispatcher,
+                      std::shared_ptr<video::FrameSource> frame_source,
+                      const Options &options) {
+  request_dispatcher.RegisterServlet(
+      "/jpeg",
+      std::make_shared<processing::servlets::Jpeg>(std::move(frame_source),
+                                                   options.kernel_pacing,
+                                                   options.multicast)
+  );
 }
 
 } // namespace
 
-int main(int /*argc*/, char **/*argv*/) {
+int main(int argc, char **argv) {
   try {
     constexpr int kRtspPortNumber = 5544;
-    constexpr int kAcceptTimeout = 2;
-
-    signal(SIGINT, SignalHandler);
 
-    Camera::GetInstance(); // Initializing camera
+    const Options options = ParseOptions(argc, argv);
 
-    processing::RequestDispatcher dispatcher = BuildRequestDispatcher();
-    std::vector<std::future<void>> futures;
+    processing::RequestDispatcher dispatcher;
 
     sock::ServerSocket server_socket(sock::Type::kTcp, kRtspPortNumber);
-    std::cout << "Server started" << std::endl;
-    while (!stop_flag) {
-      std::optional<sock::Socket> socket_opt = server_socket.TryAccept(kAcceptTimeout);
-      if (socket_opt.has_value()) {
-        std::cout << "Connected client on socket "
-                  << socket_opt.value().GetDescriptor() << std::endl;
-        auto client_socket_ptr = std::make_shared<sock::Socket>(std::move(socket_opt.value()));
-        futures.push_back(std::async(HandleClient, dispatcher, client_socket_ptr));
-      }
+    sock::Reactor reactor(server_socket, [&dispatcher]() {
+      return processing::ClientHandler(dispatcher);
+    });
+    // Must be done before streaming threads are started to be inherited by them
+    reactor.StopOnSignals({SIGINT, SIGTERM});
+    RegisterServlets(dispatcher, BuildFrameSource(argc, argv), options);
+    if (options.zero_copy) {
+      reactor.EnableZeroCopy();
     }
+    reactor.SetTimer(std::chrono::seconds(1), [&dispatcher]() {
+      dispatcher.OnTimer(std::chrono::steady_clock::now());
+    });
+
+    std::cout << "Server started" << std::endl;
+    reactor.Run();
   } catch (const std::exception &ex) {
     std::cerr << "Error: " << ex.what() << std::endl;
     return EXIT_FAILURE;
@@ -0,0 +1,223 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace pipeline {
+
+/**
+ * @brief Thread-safe FIFO queue with fixed capacity
+ * @details All slots are allocated on construction, so pushing and popping
+ * never allocate memory by themselves
+ *
+ * @tparam T Type of stored values
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Construct a new BoundedQueue object
+   *
+   * @param capacity Max number of stored values
+   */
+  explicit BoundedQueue(std::size_t capacity) :
+  slots_(capacity),
+  head_(0),
+  size_(0),
+  closed_(false),
+  mutex_(),
+  not_empty_notifier_(),
+  not_full_notifier_() {}
+
+  /**
+   * @brief Push value to the end of the queue, waiting while queue is full
+   *
+   * @param value Value to push
+   * @return true If value was pushed
+   * @return false If queue was closed
+   */
+  bool Push(T value) {
+    std::unique_lock lock(mutex_);
+    not_full_notifier_.wait(lock, [this] {
+      return (size_ < slots_.size() || closed_);
+    });
+    if (closed_) {
+      return false;
+    }
+
+    PushUnlocked(std::move(value));
+    lock.unlock();
+    not_empty_notifier_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Push value to the end of the queue if it isn't full
+   *
+   * @param value Value to push
+   * @return true If value was pushed
+   * @return false If queue is full or closed
+   */
+  bool TryPush(T &&value) {
+    {
+      std::lock_guard guard(mutex_);
+      if (size_ == slots_.size() || closed_) {
+        return false;
+      }
+
+      PushUnlocked(std::move(value));
+    }
+    not_empty_notifier_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Push value to the end of the queue, dropping the oldest value if
+   * queue is full
+   *
+   * @param value Value to push. Discarded if queue is closed
+   * @return Dropped value if queue was full
+   */
+  std::optional<T> PushDroppingOldest(T value) {
+    std::optional<T> dropped;
+    {
+      std::lock_guard guard(mutex_);
+      if (closed_) {
+        return std::nullopt;
+      }
+
+      if (size_ == slots_.size()) {
+        dropped = PopUnlocked();
+      }
+      PushUnlocked(std::move(value));
+    }
+    not_empty_notifier_.notify_one();
+
+    return dropped;
+  }
+
+  /**
+   * @brief Pop value from the beginning of the queue, waiting while queue is empty
+   *
+   * @return Value if queue is not closed
+   * @return std::nullopt in other way
+   */
+  std::optional<T> Pop() {
+    std::unique_lock lock(mutex_);
+    not_empty_notifier_.wait(lock, [this] {
+      return (size_ > 0 || closed_);
+    });
+    if (closed_) {
+      return std::nullopt;
+    }
+
+    T value = PopUnlocked();
+    lock.unlock();
+    not_full_notifier_.notify_one();
+    return value;
+  }
+
+  /**
+   * @brief Pop value from the beginning of the queue if it isn't empty
+   *
+   * @return Value if queue is not empty and not closed
+   * @return std::nullopt in other way
+   */
+  std::optional<T> TryPop() {
+    std::optional<T> value;
+    {
+      std::lock_guard guard(mutex_);
+      if (size_ == 0 || closed_) {
+        return std::nullopt;
+      }
+
+      value = PopUnlocked();
+    }
+    not_full_notifier_.notify_one();
+    return value;
+  }
+
+  /**
+   * @brief Get number of values in the queue
+   *
+   * @return Queue depth
+   */
+  std::size_t Size() const {
+    std::lock_guard guard(mutex_);
+    return size_;
+  }
+
+  /**
+   * @brief Get max number of values in the queue
+   *
+   * @return Capacity
+   */
+  std::size_t GetCapacity() const {
+    return slots_.size();
+  }
+
+  /**
+   * @brief Close queue and wake up all waiters
+   * @details Every next Pop() returns std::nullopt and every next Push() fails
+   */
+  void Close() {
+    {
+      std::lock_guard guard(mutex_);
+      closed_ = true;
+    }
+    not_empty_notifier_.notify_all();
+    not_full_notifier_.notify_all();
+  }
+
+ private:
+  std::vector<T> slots_; //!< Ring buffer of values
+  std::size_t head_; //!< Index of the first value
+  std::size_t size_; //!< Number of stored values
+  bool closed_; //!< True, if queue was closed
+  mutable std::mutex mutex_; //!< Mutex to protect all fields
+  std::condition_variable not_empty_notifier_; //!< Notified when value is pushed
+  std::condition_variable not_full_notifier_; //!< Notified when value is popped
+
+  void PushUnlocked(T &&value) {
+    slots_[(head_ + size_) % slots_.size()] = std::move(value);
+    ++size_;
+  }
+
+  T PopUnlocked() {
+    T value = std::move(slots_[head_]);
+    head_ = (head_ + 1) % slots_.size();
+    --size_;
+    return value;
+  }
+};
+
+} // namespace pipeline
@@ -0,0 +1,73 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "frame_packetizer.h"
+
+#include <algorithm>
+
+namespace pipeline {
+
+FramePacketizer::FramePacketizer() :
+entries_() {}
+
+const PacketizedFrame &FramePacketizer::Packetize(const EncodedFramePtr &frame,
+                                                  const std::size_t bytes_per_packet) {
+  // Pooled frames get new control block on every reuse, so expired or other
+  // frame means that entry is stale
+  const auto is_current = [&frame](const std::unique_ptr<Entry> &entry) {
+    return entry->frame.lock() == frame;
+  };
+
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [bytes_per_packet](const std::unique_ptr<Entry> &entry) {
+    return entry->bytes_per_packet == bytes_per_packet;
+  });
+  if (it != entries_.end() && is_current(*it)) {
+    return (*it)->packets;
+  }
+  if (it == entries_.end()) {
+    it = std::find_if_not(entries_.begin(), entries_.end(), is_current);
+  }
+  if (it == entries_.end()) {
+    entries_.push_back(std::make_unique<Entry>(Entry{
+        {}, 0, {{}, rtp::PacketArena(rtp::mjpeg::kHeadersSize)}}));
+    it = std::prev(entries_.end());
+  }
+
+  Entry &entry = **it;
+  entry.frame = frame;
+  entry.bytes_per_packet = bytes_per_packet;
+  PacketizedFrame &packets = entry.packets;
+  rtp::mjpeg::PackJpeg(frame->jpeg, bytes_per_packet, packets.fragments);
+  packets.headers.Clear();
+  for (const rtp::mjpeg::Fragment &fragment : packets.fragments) {
+    packets.headers.Commit(rtp::mjpeg::SerializeHeadersInto(
+        fragment, frame->width, frame->height, frame->quality, 0, 0, 0,
+        packets.headers.Allocate()));
+  }
+
+  return packets;
+}
+
+} // namespace pipeline
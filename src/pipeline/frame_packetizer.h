@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <vector>
+#include <memory>
+
+#include "span.h"
+#include "rtp/packet_arena.h"
+#include "rtp/mjpeg/packet.h"
+#include "pipeline.h"
+
+namespace pipeline {
+
+/**
+ * @brief Frame split into MJPEG over RTP packets, common for all streams
+ * @details RTP headers have zero sequence number, timestamp and SSRC, which
+ * every stream patches in its own copy of the headers
+ */
+struct PacketizedFrame {
+  std::vector<rtp::mjpeg::Fragment> fragments; //!< Views of the frame payload
+  rtp::PacketArena headers; //!< RTP and JPEG headers of every fragment
+};
+
+/**
+ * @brief Packetizer splitting every frame only once for all its streams
+ * @details Frames are packetized once per distinct packet size. Not
+ * thread-safe, must be used from the pipeline send stage thread only
+ */
+class FramePacketizer {
+ public:
+  FramePacketizer();
+
+  FramePacketizer(const FramePacketizer &) = delete;
+  FramePacketizer &operator=(const FramePacketizer &) = delete;
+
+  /**
+   * @brief Get packets of the frame, splitting it if it wasn't done yet
+   *
+   * @param frame Frame to be sent
+   * @param bytes_per_packet Number of JPEG bytes in one packet
+   * @return Packets valid until the next call with another frame
+   */
+  const PacketizedFrame &Packetize(const EncodedFramePtr &frame,
+                                   std::size_t bytes_per_packet);
+
+ private:
+  /**
+   * @brief Packets of one frame with one packet size
+   */
+  struct Entry {
+    std::weak_ptr<const EncodedFrame> frame; //!< Packetized frame
+    std::size_t bytes_per_packet; //!< Number of JPEG bytes in one packet
+    PacketizedFrame packets; //!< Packets of the frame
+  };
+
+  //! One entry per packet size in use. Entries of older frames are reused
+  std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+} // namespace pipeline
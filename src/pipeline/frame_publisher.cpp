@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "frame_publisher.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace pipeline {
+
+FrameSubscriber::~FrameSubscriber() {}
+
+void FrameSubscriber::Flush() {}
+
+FramePublisher::FramePublisher(std::shared_ptr<video::FrameSource> frame_source,
+                               const Pipeline::Config config) :
+frame_source_(std::move(frame_source)),
+config_(config),
+mutex_(),
+subscribers_(std::make_shared<const Subscribers>()),
+stopping_thread_(),
+pipeline_() {}
+
+FramePublisher::~FramePublisher() {
+  std::lock_guard guard(mutex_);
+  WaitForStoppedPipeline();
+}
+
+void FramePublisher::Subscribe(std::shared_ptr<FrameSubscriber> subscriber) {
+  std::lock_guard guard(mutex_);
+
+  auto subscribers = std::make_shared<Subscribers>(*subscribers_);
+  subscribers->push_back(std::move(subscriber));
+  std::atomic_store(&subscribers_,
+                    std::shared_ptr<const Subscribers>(std::move(subscribers)));
+
+  if (!pipeline_) {
+    WaitForStoppedPipeline();
+    pipeline_ = std::make_unique<Pipeline>(frame_source_, config_);
+    pipeline_->Start([this](const EncodedFramePtr &frame) {
+      Publish(frame);
+    });
+  }
+}
+
+void FramePublisher::Unsubscribe(const std::shared_ptr<FrameSubscriber> &subscriber) {
+  std::lock_guard guard(mutex_);
+
+  auto subscribers = std::make_shared<Subscribers>(*subscribers_);
+  subscribers->erase(std::remove(subscribers->begin(), subscribers->end(),
+                                 subscriber),
+                     subscribers->end());
+  const bool empty = subscribers->empty();
+  std::atomic_store(&subscribers_,
+                    std::shared_ptr<const Subscribers>(std::move(subscribers)));
+
+  if (empty && pipeline_) {
+    WaitForStoppedPipeline();
+    // Joining takes up to a frame of every stage, which mustn't hold the caller
+    stopping_thread_ = std::thread([pipeline = std::move(pipeline_)]() {
+      pipeline->Stop();
+      const Stats stats = pipeline->GetStats();
+      std::cout << "Pipeline stopped. Frames captured: " << stats.captured_frames
+                << ", encoded: " << stats.encoded_frames
+                << ", sent: " << stats.sent_frames
+                << ", dropped before encoding: " << stats.encode_dropped_frames
+                << ", dropped before sending: " << stats.send_dropped_frames
+                << std::endl;
+    });
+  }
+}
+
+std::optional<Stats> FramePublisher::GetStats() const {
+  std::lock_guard guard(mutex_);
+  if (!pipeline_) {
+    return std::nullopt;
+  }
+
+  return pipeline_->GetStats();
+}
+
+void FramePublisher::Publish(const EncodedFramePtr &frame) {
+  const std::shared_ptr<const Subscribers> subscribers = std::atomic_load(&subscribers_);
+  for (const std::shared_ptr<FrameSubscriber> &subscriber : *subscribers) {
+    try {
+      subscriber->OnFrame(frame);
+    } catch (const std::exception &ex) {
+      // One broken subscriber shouldn't affect the others
+      std::cout << "Can't publish frame " << frame->number << ": "
+                << ex.what() << std::endl;
+    }
+  }
+
+  for (const std::shared_ptr<FrameSubscriber> &subscriber : *subscribers) {
+    try {
+      subscriber->Flush();
+    } catch (const std::exception &ex) {
+      std::cout << "Can't send frame " << frame->number << ": "
+                << ex.what() << std::endl;
+    }
+  }
+}
+
+void FramePublisher::WaitForStoppedPipeline() {
+  if (stopping_thread_.joinable()) {
+    stopping_thread_.join();
+  }
+}
+
+} // namespace pipeline
@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <optional>
+
+#include "video/frame_source.h"
+#include "pipeline.h"
+
+namespace pipeline {
+
+/**
+ * @brief Interface for consumers of encoded frames
+ */
+class FrameSubscriber {
+ public:
+  virtual ~FrameSubscriber();
+
+  /**
+   * @brief Handle next encoded frame
+   * @details Called from pipeline send stage thread
+   *
+   * @param frame Shared frame. Can be kept as long as needed
+   */
+  virtual void OnFrame(const EncodedFramePtr &frame) = 0;
+
+  /**
+   * @brief Finish sending of the frame
+   * @details Called from pipeline send stage thread after the frame was passed
+   * to all subscribers, so subscribers can send their data together
+   */
+  virtual void Flush();
+};
+
+/**
+ * @brief Publisher which captures and encodes every frame once and hands it to
+ * all subscribers
+ * @details Pipeline runs only while there is at least one subscriber
+ */
+class FramePublisher {
+ public:
+  /**
+   * @brief Construct a new FramePublisher object
+   *
+   * @param frame_source Source of raw frames
+   * @param config Configuration of the pipeline
+   */
+  FramePublisher(std::shared_ptr<video::FrameSource> frame_source,
+                 Pipeline::Config config);
+
+  FramePublisher(const FramePublisher &) = delete;
+  FramePublisher &operator=(const FramePublisher &) = delete;
+
+  /**
+   * @brief Destroy the FramePublisher object waiting for the pipeline threads
+   */
+  ~FramePublisher();
+
+  /**
+   * @brief Add subscriber, starting pipeline if it's the first one
+   * @details Waits for the previous pipeline, if it's still being stopped,
+   * because frame source can't be shared by two pipelines
+   *
+   * @param subscriber Subscriber to be added
+   */
+  void Subscribe(std::shared_ptr<FrameSubscriber> subscriber);
+
+  /**
+   * @brief Remove subscriber, stopping pipeline if it was the last one
+   * @details Subscriber can still receive a frame which is being published
+   * right now. Pipeline threads are waited for in background, so the caller
+   * isn't blocked by capturing, encoding or pacing of the current frames
+   *
+   * @param subscriber Subscriber to be removed
+   */
+  void Unsubscribe(const std::shared_ptr<FrameSubscriber> &subscriber);
+
+  /**
+   * @brief Get statistics of the running pipeline
+   *
+   * @return Pipeline statistics if pipeline is running
+   * @return std::nullopt in other way
+   */
+  std::optional<Stats> GetStats() const;
+
+ private:
+  using Subscribers = std::vector<std::shared_ptr<FrameSubscriber>>;
+
+  std::shared_ptr<video::FrameSource> frame_source_; //!< Source of raw frames
+  const Pipeline::Config config_; //!< Configuration of the pipeline
+  mutable std::mutex mutex_; //!< Mutex to protect pipeline_ and subscribers_ changes
+  //! Current subscribers. Replaced as a whole on every change, so the send
+  //! stage reads it without locking mutex_
+  std::shared_ptr<const Subscribers> subscribers_;
+  //! Thread stopping the last pipeline, which still uses frame source
+  std::thread stopping_thread_;
+  //! Running pipeline. Declared last to be stopped before other fields destruction
+  std::unique_ptr<Pipeline> pipeline_;
+
+  /**
+   * @brief Hand frame to every subscriber. Used as the pipeline sink
+   *
+   * @param frame Frame to publish
+   */
+  void Publish(const EncodedFramePtr &frame);
+
+  /**
+   * @brief Wait until the last pipeline is stopped
+   * @details mutex_ must be locked
+   */
+  void WaitForStoppedPipeline();
+};
+
+} // namespace pipeline
@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "packet_history.h"
+
+#include <algorithm>
+
+namespace pipeline {
+
+PacketHistory::PacketHistory(const std::size_t capacity) :
+frames_(capacity),
+current_(0) {}
+
+void PacketHistory::NextFrame() {
+  if (frames_.empty()) {
+    return;
+  }
+
+  current_ = (current_ + 1) % frames_.size();
+  Frame &slot = frames_[current_];
+  slot.frame.reset();
+  slot.packets.clear();
+}
+
+void PacketHistory::Add(const EncodedFramePtr &frame, Span<const Byte> headers,
+                        Span<const Byte> payload, const uint16_t sequence_number) {
+  if (frames_.empty()) {
+    return;
+  }
+
+  Frame &slot = frames_[current_];
+  if (slot.packets.empty()) {
+    slot.frame = frame;
+    slot.first_sequence_number = sequence_number;
+  }
+
+  Packet &packet = slot.packets.emplace_back();
+  std::copy(headers.begin(), headers.end(), packet.headers.begin());
+  packet.payload = payload;
+  packet.retransmitted = false;
+}
+
+std::optional<PacketHistory::Entry> PacketHistory::Find(const uint16_t sequence_number) {
+  for (Frame &slot : frames_) {
+    // Distance wraps together with sequence numbers
+    const auto offset = static_cast<uint16_t>(sequence_number -
+                                              slot.first_sequence_number);
+    if (slot.frame && offset < slot.packets.size()) {
+      return Entry{slot.frame, slot.packets[offset]};
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::size_t PacketHistory::GetCapacity() const {
+  return frames_.size();
+}
+
+} // namespace pipeline
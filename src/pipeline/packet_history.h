@@ -0,0 +1,123 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+#include <array>
+#include <optional>
+
+#include "byte.h"
+#include "span.h"
+#include "rtp/mjpeg/packet.h"
+#include "pipeline.h"
+
+namespace pipeline {
+
+/**
+ * @brief Ring of the packets of the last frames of one stream
+ * @details Packets are found by sequence number for retransmission. Only
+ * headers are copied, payloads are views of the encoded frames, which are
+ * kept alive by the ring. Ring advances with every frame passed to the
+ * stream, even dropped one, so all streams keep only the same last frames.
+ * Slots are reused, so after the largest frame no more allocations happen
+ */
+class PacketHistory {
+ public:
+  /**
+   * @brief Sent packet
+   */
+  struct Packet {
+    std::array<Byte, rtp::mjpeg::kHeadersSize> headers; //!< RTP and JPEG headers
+    Span<const Byte> payload; //!< View of the frame
+    bool retransmitted; //!< True, if packet was already retransmitted
+  };
+
+  /**
+   * @brief Found packet with its frame
+   */
+  struct Entry {
+    const EncodedFramePtr &frame; //!< Frame of the payload
+    Packet &packet; //!< Packet
+  };
+
+  /**
+   * @brief Construct a new PacketHistory object
+   *
+   * @param capacity Number of the last frames to keep packets of. 0 keeps
+   * nothing
+   */
+  explicit PacketHistory(std::size_t capacity);
+
+  /**
+   * @brief Start the slot of the next frame, forgetting the oldest frame
+   * @details Invalidates entries of the oldest frame only
+   */
+  void NextFrame();
+
+  /**
+   * @brief Remember sent packet of the current frame
+   * @details Packets of one frame must have consecutive sequence numbers
+   *
+   * @param frame Frame of the payload
+   * @param headers Patched RTP and JPEG headers of kHeadersSize
+   * @param payload View of the frame
+   * @param sequence_number Sequence number of the packet
+   */
+  void Add(const EncodedFramePtr &frame, Span<const Byte> headers,
+           Span<const Byte> payload, uint16_t sequence_number);
+
+  /**
+   * @brief Find packet by sequence number
+   *
+   * @param sequence_number Sequence number of the packet
+   * @return Packet if it's still kept
+   */
+  std::optional<Entry> Find(uint16_t sequence_number);
+
+  /**
+   * @brief Get number of the last frames to keep packets of
+   *
+   * @return Capacity of the ring in frames
+   */
+  std::size_t GetCapacity() const;
+
+ private:
+  /**
+   * @brief Packets of one frame
+   */
+  struct Frame {
+    EncodedFramePtr frame; //!< Frame of the payloads or nullptr if slot is empty
+    uint16_t first_sequence_number; //!< Sequence number of the first packet
+    std::vector<Packet> packets; //!< Packets in order
+  };
+
+  std::vector<Frame> frames_; //!< Slots of frames
+  std::size_t current_; //!< Index of the slot of the current frame
+};
+
+} // namespace pipeline
@@ -0,0 +1,190 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "pipeline.h"
+
+#include <iostream>
+#include <utility>
+
+#include "video/jpeg_encoder.h"
+
+namespace {
+
+//! Frames being processed by stage threads in addition to the queued ones
+const std::size_t kFramesInStages = 2;
+
+} // namespace
+
+namespace pipeline {
+
+Pipeline::Pipeline(std::shared_ptr<video::FrameSource> frame_source,
+                   const Config config) :
+frame_source_(std::move(frame_source)),
+config_(config),
+sink_(),
+free_raw_frames_(config_.queue_capacity + kFramesInStages),
+encode_queue_(config_.queue_capacity),
+free_encoded_frames_(std::make_shared<EncodedFramesPool>(
+    config_.queue_capacity + kFramesInStages + config_.retained_frames)),
+send_queue_(config_.queue_capacity),
+captured_frames_(0),
+encoded_frames_(0),
+sent_frames_(0),
+encode_dropped_frames_(0),
+send_dropped_frames_(0),
+capture_thread_(),
+encode_thread_(),
+send_thread_() {
+  for (std::size_t i = 0; i < free_raw_frames_.GetCapacity(); ++i) {
+    free_raw_frames_.Push({Bytes(frame_source_->GetFrameSize()), 0, {}});
+  }
+
+  for (std::size_t i = 0; i < free_encoded_frames_->GetCapacity(); ++i) {
+    free_encoded_frames_->Push(std::make_unique<EncodedFrame>());
+  }
+}
+
+Pipeline::~Pipeline() {
+  Stop();
+}
+
+void Pipeline::Start(Sink sink) {
+  sink_ = std::move(sink);
+  capture_thread_ = std::thread(&Pipeline::CaptureThread, this);
+  encode_thread_ = std::thread(&Pipeline::EncodeThread, this);
+  send_thread_ = std::thread(&Pipeline::SendThread, this);
+}
+
+void Pipeline::Stop() {
+  free_raw_frames_.Close();
+  encode_queue_.Close();
+  send_queue_.Close();
+
+  for (std::thread *thread : {&capture_thread_, &encode_thread_, &send_thread_}) {
+    if (thread->joinable()) {
+      thread->join();
+    }
+  }
+}
+
+Stats Pipeline::GetStats() const {
+  return {
+      free_raw_frames_.Size(),
+      encode_queue_.Size(),
+      send_queue_.Size(),
+      captured_frames_,
+      encoded_frames_,
+      sent_frames_,
+      encode_dropped_frames_,
+      send_dropped_frames_
+  };
+}
+
+void Pipeline::CaptureThread() {
+  try {
+    uint64_t frame_number = 0;
+    while (std::optional<RawFrame> frame = free_raw_frames_.Pop()) {
+      frame_source_->Grab(frame->data.data());
+      frame->number = frame_number++;
+      frame->capture_time = std::chrono::steady_clock::now();
+      ++captured_frames_;
+
+      std::optional<RawFrame> dropped = PassToNextStage(
+          encode_queue_, std::move(*frame), encode_dropped_frames_);
+      if (dropped) {
+        free_raw_frames_.Push(std::move(*dropped));
+      }
+    }
+  } catch (const std::exception &ex) {
+    std::cout << "Capture stage stopped: " << ex.what() << std::endl;
+  }
+}
+
+void Pipeline::EncodeThread() {
+  video::JpegEncoder encoder(frame_source_->GetWidth(),
+                             frame_source_->GetHeight(), config_.quality);
+
+  while (std::optional<RawFrame> raw_frame = encode_queue_.Pop()) {
+    std::shared_ptr<EncodedFrame> encoded_frame = AcquireEncodedFrame();
+
+    encoder.Encode(raw_frame->data.data(), encoded_frame->jpeg);
+    encoded_frame->width = frame_source_->GetWidth();
+    encoded_frame->height = frame_source_->GetHeight();
+    encoded_frame->quality = config_.quality;
+    encoded_frame->number = raw_frame->number;
+    encoded_frame->capture_time = raw_frame->capture_time;
+    free_raw_frames_.Push(std::move(*raw_frame));
+    ++encoded_frames_;
+
+    // Dropped frame returns to the pool by itself
+    PassToNextStage<EncodedFramePtr>(send_queue_, std::move(encoded_frame),
+                                     send_dropped_frames_);
+  }
+}
+
+void Pipeline::SendThread() {
+  while (std::optional<EncodedFramePtr> frame = send_queue_.Pop()) {
+    try {
+      sink_(*frame);
+      ++sent_frames_;
+    } catch (const std::exception &ex) {
+      std::cout << "Can't send frame " << (*frame)->number << ": "
+                << ex.what() << std::endl;
+    }
+  }
+}
+
+std::shared_ptr<EncodedFrame> Pipeline::AcquireEncodedFrame() {
+  std::optional<std::unique_ptr<EncodedFrame>> pooled = free_encoded_frames_->TryPop();
+  std::unique_ptr<EncodedFrame> frame = (pooled ? std::move(*pooled) :
+                                         std::make_unique<EncodedFrame>());
+
+  return std::shared_ptr<EncodedFrame>(
+      frame.release(),
+      [pool = free_encoded_frames_](EncodedFrame *released_frame) {
+        std::unique_ptr<EncodedFrame> frame_ptr(released_frame);
+        // Frame is simply freed if pool is full
+        pool->TryPush(std::move(frame_ptr));
+      }
+  );
+}
+
+template <typename Frame>
+std::optional<Frame> Pipeline::PassToNextStage(BoundedQueue<Frame> &queue,
+                                               Frame &&frame,
+                                               std::atomic<uint64_t> &dropped_frames) {
+  if (!config_.drop_stale_frames) {
+    queue.Push(std::move(frame));
+    return std::nullopt;
+  }
+
+  std::optional<Frame> dropped = queue.PushDroppingOldest(std::move(frame));
+  if (dropped) {
+    ++dropped_frames;
+  }
+
+  return dropped;
+}
+
+} // namespace pipeline
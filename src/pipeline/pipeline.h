@@ -0,0 +1,202 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "byte.h"
+#include "video/frame_source.h"
+#include "bounded_queue.h"
+
+namespace pipeline {
+
+/**
+ * @brief JPEG image ready to be sent
+ */
+struct EncodedFrame {
+  Bytes jpeg; //!< JPEG image
+  unsigned int width; //!< Image width
+  unsigned int height; //!< Image height
+  int quality; //!< JPEG quality in [0-100] range
+  uint64_t number; //!< Number of the frame since pipeline start
+  std::chrono::steady_clock::time_point capture_time; //!< Moment of capturing
+};
+
+/**
+ * @brief Pipeline statistics
+ */
+struct Stats {
+  std::size_t capture_queue_depth; //!< Free raw frames waiting for capturing
+  std::size_t encode_queue_depth; //!< Raw frames waiting for encoding
+  std::size_t send_queue_depth; //!< Encoded frames waiting for sending
+  uint64_t captured_frames; //!< Number of captured frames
+  uint64_t encoded_frames; //!< Number of encoded frames
+  uint64_t sent_frames; //!< Number of frames passed to the sink
+  //! Number of stale raw frames dropped from the encode queue
+  uint64_t encode_dropped_frames;
+  //! Number of stale encoded frames dropped from the send queue
+  uint64_t send_dropped_frames;
+};
+
+//! Reference-counted encoded frame shared between all its consumers
+using EncodedFramePtr = std::shared_ptr<const EncodedFrame>;
+
+/**
+ * @brief Three-stage capture -> encode -> send pipeline
+ * @details Every stage runs in its own thread. Stages are connected with
+ * bounded queues, so throughput is limited by the slowest stage instead of
+ * sum of all stages latencies
+ */
+class Pipeline {
+ public:
+  //! Function called from send stage for every encoded frame
+  using Sink = std::function<void(const EncodedFramePtr &)>;
+
+  /**
+   * @brief Pipeline configuration
+   */
+  struct Config {
+    std::size_t queue_capacity; //!< Max number of frames in every queue
+    //! If true, the oldest frame is dropped when the next stage is too slow.
+    //! Otherwise the previous stage waits
+    bool drop_stale_frames;
+    int quality; //!< JPEG quality in [0-100] range
+    //! Max number of frames consumers keep after sending, e.g. queued to
+    //! slow clients or for retransmission. Pool of encoded frames covers them
+    std::size_t retained_frames;
+  };
+
+  /**
+   * @brief Construct a new Pipeline object
+   * @details Memory for all frames is allocated here
+   *
+   * @param frame_source Source of raw frames
+   * @param config Pipeline configuration
+   */
+  Pipeline(std::shared_ptr<video::FrameSource> frame_source, Config config);
+
+  Pipeline(const Pipeline &) = delete;
+  Pipeline &operator=(const Pipeline &) = delete;
+
+  /**
+   * @brief Destroy the Pipeline object stopping it if it is running
+   */
+  ~Pipeline();
+
+  /**
+   * @brief Start all stages
+   *
+   * @param sink Function to be called for every encoded frame
+   */
+  void Start(Sink sink);
+
+  /**
+   * @brief Stop all stages and wait for their threads
+   */
+  void Stop();
+
+  /**
+   * @brief Get current pipeline statistics
+   *
+   * @return Queues depths and frame counters
+   */
+  Stats GetStats() const;
+
+ private:
+  /**
+   * @brief Raw frame with its capture metadata
+   */
+  struct RawFrame {
+    Bytes data; //!< Packed RGB pixels
+    uint64_t number; //!< Number of the frame since pipeline start
+    std::chrono::steady_clock::time_point capture_time; //!< Moment of capturing
+  };
+
+  //! Pool of encoded frames. Shared with frames deleters, because frames can
+  //! outlive the pipeline
+  using EncodedFramesPool = BoundedQueue<std::unique_ptr<EncodedFrame>>;
+
+  std::shared_ptr<video::FrameSource> frame_source_; //!< Source of raw frames
+  const Config config_; //!< Pipeline configuration
+  Sink sink_; //!< Consumer of encoded frames
+  BoundedQueue<RawFrame> free_raw_frames_; //!< Preallocated raw frames
+  BoundedQueue<RawFrame> encode_queue_; //!< Captured frames waiting for encoding
+  //! Encoded frames released by all consumers
+  std::shared_ptr<EncodedFramesPool> free_encoded_frames_;
+  BoundedQueue<EncodedFramePtr> send_queue_; //!< Encoded frames waiting for sending
+  std::atomic<uint64_t> captured_frames_; //!< Number of captured frames
+  std::atomic<uint64_t> encoded_frames_; //!< Number of encoded frames
+  std::atomic<uint64_t> sent_frames_; //!< Number of frames passed to the sink
+  std::atomic<uint64_t> encode_dropped_frames_; //!< Frames dropped before encoding
+  std::atomic<uint64_t> send_dropped_frames_; //!< Frames dropped before sending
+  std::thread capture_thread_; //!< Thread of capture stage
+  std::thread encode_thread_; //!< Thread of encode stage
+  std::thread send_thread_; //!< Thread of send stage
+
+  /**
+   * @brief Grab frames from source and pass them to encode stage
+   */
+  void CaptureThread();
+
+  /**
+   * @brief Encode raw frames to JPEG and pass them to send stage
+   */
+  void EncodeThread();
+
+  /**
+   * @brief Pass encoded frames to the sink
+   */
+  void SendThread();
+
+  /**
+   * @brief Get encoded frame from pool or allocate new one if pool is empty
+   * @details Frame returns to the pool when the last reference is released.
+   * Pool is empty only if consumers keep more frames than configured
+   *
+   * @return Encoded frame
+   */
+  std::shared_ptr<EncodedFrame> AcquireEncodedFrame();
+
+  /**
+   * @brief Pass frame to the next stage according to the drop policy
+   *
+   * @param queue Queue of the next stage
+   * @param frame Frame to pass
+   * @param dropped_frames Counter of frames dropped from the queue
+   * @return Dropped frame if any
+   */
+  template <typename Frame>
+  std::optional<Frame> PassToNextStage(BoundedQueue<Frame> &queue, Frame &&frame,
+                                       std::atomic<uint64_t> &dropped_frames);
+};
+
+} // namespace pipeline
@@ -0,0 +1,336 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "rtcp_channel.h"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <random>
+#include <utility>
+#include <algorithm>
+
+#include "span.h"
+#include "sock/exception.h"
+#include "rtsp/interleaved.h"
+
+namespace {
+
+//! Average time between reports of one stream. Minimum of RFC 3550
+const std::chrono::milliseconds kReportInterval = std::chrono::seconds(5);
+//! Time before the first report of the stream
+const std::chrono::milliseconds kFirstReportDelay = std::chrono::seconds(1);
+//! Max size of RTCP packet
+const std::size_t kMaxPacketSize = 1500;
+
+/**
+ * @brief Get random report interval
+ * @details Randomization in [0.5, 1.5] range keeps reports of different
+ * streams from synchronizing
+ *
+ * @return Interval until the next report
+ */
+std::chrono::steady_clock::duration GetRandomReportInterval() {
+  static thread_local std::mt19937 mersenne(std::random_device{}());
+  std::uniform_real_distribution<double> distribution(0.5, 1.5);
+
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      kReportInterval * distribution(mersenne));
+}
+
+/**
+ * @brief Build canonical name of streams of this host
+ *
+ * @return CNAME in user@host form
+ */
+std::string BuildCanonicalName() {
+  char host_name[256] = {};
+  if (gethostname(host_name, sizeof(host_name) - 1) != 0) {
+    std::strcpy(host_name, "localhost");
+  }
+
+  return std::string("pi-rtsp-server@") + host_name;
+}
+
+} // namespace
+
+namespace pipeline {
+
+RtcpChannel::RtcpChannel(const int port, const sock::MulticastOptions &multicast) :
+socket_(sock::Type::kUdp, port),
+wake_descriptor_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+stopping_(false),
+canonical_name_(BuildCanonicalName()),
+mutex_(),
+destinations_(),
+buffer_(kMaxPacketSize),
+feedback_(),
+interleaved_feedback_(),
+thread_() {
+  if (wake_descriptor_ < 0) {
+    throw sock::SocketException(std::string("Can't create eventfd: ") +
+                                strerror(errno));
+  }
+  socket_.SetMulticastOptions(multicast);
+
+  thread_ = std::thread(&RtcpChannel::Run, this);
+}
+
+RtcpChannel::~RtcpChannel() {
+  stopping_ = true;
+  Wake();
+
+  thread_.join();
+  close(wake_descriptor_);
+}
+
+void RtcpChannel::Add(std::shared_ptr<RtpStreamer> streamer,
+                      const std::string &client_ip, const int client_port) {
+  const uint32_t ssrc = streamer->GetSynchronizationSource();
+  Destination destination = {std::move(streamer),
+                             sock::Address(client_ip, client_port),
+                             nullptr,
+                             nullptr,
+                             0,
+                             std::chrono::steady_clock::now() + kFirstReportDelay};
+
+  std::lock_guard lock(mutex_);
+  destinations_.insert_or_assign(ssrc, std::move(destination));
+}
+
+void RtcpChannel::Add(std::shared_ptr<RtpStreamer> streamer,
+                      std::shared_ptr<UdpTransport> transport) {
+  const uint32_t ssrc = streamer->GetSynchronizationSource();
+  Destination destination = {std::move(streamer),
+                             std::nullopt,
+                             std::move(transport),
+                             nullptr,
+                             0,
+                             std::chrono::steady_clock::now() + kFirstReportDelay};
+
+  {
+    std::lock_guard lock(mutex_);
+    destinations_.insert_or_assign(ssrc, std::move(destination));
+  }
+  Wake();
+}
+
+void RtcpChannel::Add(std::shared_ptr<RtpStreamer> streamer,
+                      std::shared_ptr<sock::SharedOutput> output,
+                      const uint8_t channel) {
+  const uint32_t ssrc = streamer->GetSynchronizationSource();
+  Destination destination = {std::move(streamer),
+                             std::nullopt,
+                             nullptr,
+                             std::move(output),
+                             channel,
+                             std::chrono::steady_clock::now() + kFirstReportDelay};
+
+  std::lock_guard lock(mutex_);
+  destinations_.insert_or_assign(ssrc, std::move(destination));
+}
+
+void RtcpChannel::Remove(const std::shared_ptr<RtpStreamer> &streamer) {
+  bool had_transport = false;
+  {
+    std::lock_guard lock(mutex_);
+    auto it = destinations_.find(streamer->GetSynchronizationSource());
+    if (it == destinations_.end()) {
+      return;
+    }
+    had_transport = (it->second.transport != nullptr);
+    destinations_.erase(it);
+  }
+
+  // Thread releases its reference, so ports of the session are freed soon
+  if (had_transport) {
+    Wake();
+  }
+}
+
+void RtcpChannel::Wake() {
+  const uint64_t value = 1;
+  if (write(wake_descriptor_, &value, sizeof(value)) < 0) {
+    std::cerr << "Can't wake up RTCP channel: " << strerror(errno) << std::endl;
+  }
+}
+
+void RtcpChannel::Run() {
+  std::vector<pollfd> descriptors;
+  std::vector<std::shared_ptr<UdpTransport>> transports;
+
+  while (!stopping_) {
+    const auto next_report_time = SendReports();
+    const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        next_report_time - std::chrono::steady_clock::now()).count() + 1;
+
+    transports.clear();
+    {
+      std::lock_guard lock(mutex_);
+      for (const auto &[ssrc, destination] : destinations_) {
+        if (destination.transport) {
+          transports.push_back(destination.transport);
+        }
+      }
+    }
+    descriptors = {
+        {wake_descriptor_, POLLIN, 0},
+        {socket_.GetDescriptor(), POLLIN, 0}
+    };
+    for (const std::shared_ptr<UdpTransport> &transport : transports) {
+      descriptors.push_back({transport->GetRtcpSocket().GetDescriptor(), POLLIN, 0});
+    }
+
+    const int res = poll(descriptors.data(), descriptors.size(),
+                         static_cast<int>(std::max<long long>(timeout, 0)));
+    if (res < 0 && errno != EINTR) {
+      std::cerr << "RTCP channel failed: " << strerror(errno) << std::endl;
+      return;
+    }
+
+    if (descriptors[0].revents & POLLIN) {
+      uint64_t value = 0;
+      if (read(wake_descriptor_, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        std::cerr << "Can't read RTCP channel wake up: " << strerror(errno)
+                  << std::endl;
+      }
+    }
+    if (descriptors[1].revents & POLLIN) {
+      try {
+        ReceiveReports(socket_);
+      } catch (const sock::ReadError &ex) {
+        std::cout << "Can't receive RTCP report: " << ex.what() << std::endl;
+      }
+    }
+    // Connected sockets also report ICMP errors of their clients. Client,
+    // which is gone, gets them for every report, so only the first is logged
+    for (std::size_t i = 0; i < transports.size(); ++i) {
+      if (!(descriptors[i + 2].revents & (POLLIN | POLLERR))) {
+        continue;
+      }
+      try {
+        ReceiveReports(transports[i]->GetRtcpSocket());
+      } catch (const sock::ReadError &ex) {
+        if (transports[i]->MarkError()) {
+          std::cout << "Can't receive RTCP report of the session on port "
+                    << transports[i]->GetServerPorts().second << ": "
+                    << ex.what() << std::endl;
+        }
+      }
+    }
+  }
+}
+
+std::chrono::steady_clock::time_point RtcpChannel::SendReports() {
+  // Streams added while the thread waits get their first report in time
+  const auto now = std::chrono::steady_clock::now();
+  auto next_report_time = now + kFirstReportDelay;
+
+  std::lock_guard lock(mutex_);
+  for (auto &[ssrc, destination] : destinations_) {
+    if (destination.next_report_time > now) {
+      next_report_time = std::min(next_report_time, destination.next_report_time);
+      continue;
+    }
+
+    destination.next_report_time = now + GetRandomReportInterval();
+    next_report_time = std::min(next_report_time, destination.next_report_time);
+
+    const std::optional<rtcp::SenderReport> report =
+        destination.streamer->BuildSenderReport();
+    if (!report) {
+      continue;
+    }
+
+    // Compound packet must carry CNAME of the source
+    rtcp::SourceDescription description;
+    description.synchronization_source = ssrc;
+    description.canonical_name = canonical_name_;
+
+    const std::size_t report_size = report->SerializeInto(buffer_);
+    const std::size_t size = report_size + description.SerializeInto(
+        Span<Byte>(buffer_).subspan(report_size));
+    const Span<const Byte> packet = Span<const Byte>(buffer_).subspan(0, size);
+    if (destination.output) {
+      // Report is lost, if connection is congested. Next one will come soon
+      rtsp::InterleavedHeader header = rtsp::BuildInterleavedHeader(
+          destination.channel, static_cast<uint16_t>(size));
+      const Span<const Byte> parts[] = {header, packet};
+      destination.output->Write(parts, std::size(parts));
+      continue;
+    }
+
+    const Span<const Byte> parts[] = {packet};
+    try {
+      if (destination.transport) {
+        destination.transport->GetRtcpSocket().Send(parts);
+      } else {
+        socket_.SendTo(parts, destination.address.value());
+      }
+    } catch (const sock::SendError &ex) {
+      std::cout << "Can't send RTCP report: " << ex.what() << std::endl;
+    }
+  }
+
+  return next_report_time;
+}
+
+void RtcpChannel::ReceivePacket(Span<const Byte> packet) {
+  HandlePacket(packet, interleaved_feedback_);
+}
+
+void RtcpChannel::ReceiveReports(sock::Socket &socket) {
+  while (std::optional<std::size_t> size = socket.TryReceive(buffer_)) {
+    HandlePacket(Span<const Byte>(buffer_).subspan(0, *size), feedback_);
+  }
+}
+
+void RtcpChannel::HandlePacket(Span<const Byte> packet, rtcp::Feedback &feedback) {
+  const uint64_t arrival_time = rtcp::ToNtpTimestamp(std::chrono::system_clock::now());
+  try {
+    rtcp::ParseFeedback(packet, feedback);
+  } catch (const rtcp::ParseError &ex) {
+    std::cout << "Invalid RTCP packet: " << ex.what() << std::endl;
+    return;
+  }
+
+  std::lock_guard lock(mutex_);
+  for (const rtcp::ReportBlock &block : feedback.blocks) {
+    auto it = destinations_.find(block.source);
+    if (it != destinations_.end()) {
+      it->second.streamer->OnReceptionReport(block, arrival_time);
+    }
+  }
+  for (const rtcp::GenericNack &nack : feedback.nacks) {
+    auto it = destinations_.find(nack.media_source);
+    if (it != destinations_.end()) {
+      it->second.streamer->OnNack(nack);
+    }
+  }
+}
+
+} // namespace pipeline
@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "byte.h"
+#include "sock/server_socket.h"
+#include "sock/address.h"
+#include "sock/shared_output.h"
+#include "rtcp/packet.h"
+#include "rtp_streamer.h"
+#include "udp_transport.h"
+
+namespace pipeline {
+
+/**
+ * @brief RTCP channel of all RTP streams
+ * @details Periodically sends sender reports of every stream to its client
+ * and passes reception reports and NACKs from clients to the streams. Works
+ * in its own thread. Streams with their own UDP sockets are reported through them
+ * and streams interleaved into RTSP connections are reported over these
+ * connections
+ */
+class RtcpChannel {
+ public:
+  /**
+   * @brief Construct a new RtcpChannel object and start its thread
+   * @throws sock::BindError if port can't be bound
+   * @throws sock::SocketException if multicast options can't be set
+   *
+   * @param port Local RTCP port
+   * @param multicast Options of reports sent to multicast groups
+   */
+  RtcpChannel(int port, const sock::MulticastOptions &multicast);
+
+  RtcpChannel(const RtcpChannel &) = delete;
+  RtcpChannel &operator=(const RtcpChannel &) = delete;
+
+  /**
+   * @brief Stop the thread
+   */
+  ~RtcpChannel();
+
+  /**
+   * @brief Start reporting the stream to the client
+   * @details Thread-safe
+   *
+   * @param streamer Stream to report
+   * @param client_ip Client ip address
+   * @param client_port Client RTCP port
+   */
+  void Add(std::shared_ptr<RtpStreamer> streamer, const std::string &client_ip,
+           int client_port);
+
+  /**
+   * @brief Start reporting the stream through RTCP socket of the session
+   * @details Thread-safe
+   *
+   * @param streamer Stream to report
+   * @param transport Sockets of the session connected to the client
+   */
+  void Add(std::shared_ptr<RtpStreamer> streamer,
+           std::shared_ptr<UdpTransport> transport);
+
+  /**
+   * @brief Start reporting the stream over RTSP connection of the client
+   * @details Thread-safe
+   *
+   * @param streamer Stream to report
+   * @param output Output of the client RTSP connection
+   * @param channel Interleaved channel of RTCP
+   */
+  void Add(std::shared_ptr<RtpStreamer> streamer,
+           std::shared_ptr<sock::SharedOutput> output, uint8_t channel);
+
+  /**
+   * @brief Stop reporting the stream
+   * @details Thread-safe
+   *
+   * @param streamer Previously added stream
+   */
+  void Remove(const std::shared_ptr<RtpStreamer> &streamer);
+
+  /**
+   * @brief Pass feedback of the packet received not by the channel to the streams
+   * @details Used for RTCP interleaved into RTSP connections. Must be called
+   * from one thread only
+   *
+   * @param packet Compound RTCP packet
+   */
+  void ReceivePacket(Span<const Byte> packet);
+
+ private:
+  /**
+   * @brief Reported stream
+   */
+  struct Destination {
+    std::shared_ptr<RtpStreamer> streamer; //!< Stream to report
+    std::optional<sock::Address> address; //!< Client RTCP address for UDP
+    //! Sockets of the session, if it has its own ones
+    std::shared_ptr<UdpTransport> transport;
+    //! Output of the client RTSP connection for interleaved RTCP
+    std::shared_ptr<sock::SharedOutput> output;
+    uint8_t channel; //!< Interleaved channel of RTCP
+    std::chrono::steady_clock::time_point next_report_time; //!< When to send report
+  };
+
+  sock::ServerSocket socket_; //!< Socket bound to RTCP port
+  const int wake_descriptor_; //!< Eventfd used to wake up the thread
+  std::atomic<bool> stopping_; //!< True, if the thread must exit
+  const std::string canonical_name_; //!< CNAME of all streams
+  std::mutex mutex_; //!< Mutex to protect destinations_
+  std::unordered_map<uint32_t, Destination> destinations_; //!< Streams by SSRC
+  std::vector<Byte> buffer_; //!< Buffer for sent and received packets
+  rtcp::Feedback feedback_; //!< Feedback of the received packet
+  //! Feedback of the packet passed to ReceivePacket()
+  rtcp::Feedback interleaved_feedback_;
+  std::thread thread_; //!< Thread sending and receiving reports
+
+  /**
+   * @brief Wait for reports and send own ones until stopped
+   */
+  void Run();
+
+  /**
+   * @brief Wake up the thread, so it polls the current set of sockets
+   */
+  void Wake();
+
+  /**
+   * @brief Send reports of all streams, which are due
+   *
+   * @return Time of the next report
+   */
+  std::chrono::steady_clock::time_point SendReports();
+
+  /**
+   * @brief Receive all pending packets and pass their feedback to the streams
+   * @throws sock::ReadError if receiving failed
+   *
+   * @param socket Socket to receive from
+   */
+  void ReceiveReports(sock::Socket &socket);
+
+  /**
+   * @brief Pass reports and NACKs of the packet to the streams
+   *
+   * @param packet Compound RTCP packet
+   * @param feedback Buffer for parsed feedback
+   */
+  void HandlePacket(Span<const Byte> packet, rtcp::Feedback &feedback);
+};
+
+} // namespace pipeline
@@ -0,0 +1,284 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "rtp_egress.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+namespace {
+
+//! Max number of retries, when kernel is temporarily out of buffers
+const int kMaxRetries = 3;
+//! Max number of segments in one GSO datagram (UDP_MAX_SEGMENTS)
+const std::size_t kMaxSegments = 64;
+//! Max size of one GSO datagram
+const std::size_t kMaxSegmentedSize = 65'507;
+//! Min time between paced bursts of one stream, so timers stay cheap
+const std::chrono::nanoseconds kMinBurstInterval = std::chrono::microseconds(200);
+//! Delay of kernel paced datagrams, so they are not late when reach qdisc
+const std::chrono::nanoseconds kKernelPacingLead = std::chrono::microseconds(500);
+
+/**
+ * @brief Get current time
+ *
+ * @return Nanoseconds of CLOCK_MONOTONIC, which std::chrono::steady_clock uses
+ */
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+namespace pipeline {
+
+RtpEgress::RtpEgress(const Config &config) :
+socket_(sock::Type::kUdp, config.port),
+batch_(),
+segmentation_enabled_(socket_.SupportsSegmentation()),
+kernel_pacing_(config.kernel_pacing && socket_.EnableSendTimes()),
+blocked_sockets_(),
+failed_datagrams_(0),
+last_send_error_(0) {
+  if (config.kernel_pacing && !kernel_pacing_) {
+    std::cout << "SO_TXTIME is not supported, pacing in user space" << std::endl;
+  }
+  socket_.SetMulticastOptions(config.multicast);
+}
+
+void RtpEgress::AttachSocket(sock::Socket &socket) {
+  if (kernel_pacing_ && !socket.EnableSendTimes()) {
+    std::cout << "Can't enable SO_TXTIME on the session socket" << std::endl;
+  }
+}
+
+void RtpEgress::Queue(const sock::Address &address,
+                      Span<const Span<const Byte>> parts) {
+  batch_.Add(address, parts);
+}
+
+void RtpEgress::QueueSegments(const sock::Address &address,
+                              Span<const Span<const Byte>> parts,
+                              const uint16_t segment_size,
+                              const std::chrono::nanoseconds pacing_window) {
+  QueueSegments(&address, nullptr, parts, segment_size, pacing_window);
+}
+
+void RtpEgress::QueueSegments(sock::Socket &socket,
+                              Span<const Span<const Byte>> parts,
+                              const uint16_t segment_size,
+                              const std::chrono::nanoseconds pacing_window) {
+  QueueSegments(nullptr, &socket, parts, segment_size, pacing_window);
+}
+
+void RtpEgress::QueueSegments(const sock::Address *address, sock::Socket *socket,
+                              Span<const Span<const Byte>> parts,
+                              const uint16_t segment_size,
+                              const std::chrono::nanoseconds pacing_window) {
+  std::size_t total_size = 0;
+  for (const Span<const Byte> &part : parts) {
+    total_size += part.size();
+  }
+  const std::size_t segments_count = (total_size + segment_size - 1) / segment_size;
+
+  // Segments are sent in evenly spaced bursts
+  std::size_t bursts_count = 1;
+  if (pacing_window > std::chrono::nanoseconds::zero() && segments_count > 1) {
+    bursts_count = std::clamp<std::size_t>(pacing_window / kMinBurstInterval,
+                                           1, segments_count);
+  }
+  const std::size_t segments_per_burst =
+      (segments_count + bursts_count - 1) / bursts_count;
+  const uint64_t burst_interval = (pacing_window / bursts_count).count();
+  uint64_t start_time = 0;
+  if (bursts_count > 1) {
+    start_time = Now() + (kernel_pacing_ ? kKernelPacingLead.count() : 0);
+  }
+
+  const std::size_t max_segments = segmentation_enabled_ ?
+      std::min(kMaxSegments, kMaxSegmentedSize / segment_size) : 1;
+
+  std::size_t first_part = 0;
+  std::size_t segment_bytes = 0;
+  std::size_t segments = 0;
+  std::size_t segment_index = 0;
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    segment_bytes += parts[i].size();
+    const bool last = (i + 1 == parts.size());
+    if (segment_bytes < segment_size && !last) {
+      continue;
+    }
+
+    segment_bytes = 0;
+    ++segments;
+    ++segment_index;
+    const bool burst_end = (segment_index % segments_per_burst == 0);
+    if (segments == max_segments || burst_end || last) {
+      const std::size_t burst = (segment_index - 1) / segments_per_burst;
+      const uint64_t send_time = (start_time != 0 ?
+                                  start_time + burst * burst_interval : 0);
+      Add(address, socket, parts.subspan(first_part, i + 1 - first_part),
+          segments > 1 ? segment_size : 0, send_time);
+      first_part = i + 1;
+      segments = 0;
+    }
+  }
+}
+
+void RtpEgress::Flush() {
+  // Streams check their sockets after every Flush(), but only the first one
+  // of the frame has datagrams
+  if (batch_.Size() == 0) {
+    return;
+  }
+  blocked_sockets_.clear();
+  batch_.SortBySendTime();
+
+  std::size_t first = 0;
+  while (first < batch_.Size()) {
+    std::size_t end = batch_.Size();
+    if (!kernel_pacing_) {
+      // Sleep until the next datagram is due and send all due ones
+      const std::chrono::steady_clock::time_point send_time(
+          std::chrono::nanoseconds(batch_.GetSendTime(first)));
+      std::this_thread::sleep_until(send_time);
+
+      const uint64_t now = Now();
+      end = first + 1;
+      while (end < batch_.Size() && batch_.GetSendTime(end) <= now) {
+        ++end;
+      }
+    }
+
+    first = Send(first, end);
+  }
+
+  batch_.Clear();
+
+  // Broken destination fails every datagram, so errors are logged once a flush
+  if (failed_datagrams_ != 0) {
+    std::cout << "Can't send " << failed_datagrams_ << " datagrams: "
+              << strerror(last_send_error_) << std::endl;
+    failed_datagrams_ = 0;
+  }
+}
+
+void RtpEgress::Add(const sock::Address *address, sock::Socket *socket,
+                    Span<const Span<const Byte>> parts, const uint16_t segment_size,
+                    const uint64_t send_time) {
+  if (socket != nullptr) {
+    batch_.Add(*socket, parts, segment_size, send_time);
+  } else {
+    batch_.Add(*address, parts, segment_size, send_time);
+  }
+}
+
+bool RtpEgress::IsBlocked(const sock::Socket &socket) const {
+  return std::find(blocked_sockets_.begin(), blocked_sockets_.end(), &socket) !=
+      blocked_sockets_.end();
+}
+
+std::size_t RtpEgress::Send(std::size_t first, std::size_t end) {
+  while (first < end) {
+    sock::Socket *const connected_socket = batch_.GetSocket(first);
+    std::size_t socket_end = first + 1;
+    while (socket_end < end && batch_.GetSocket(socket_end) == connected_socket) {
+      ++socket_end;
+    }
+
+    // The rest of the frame is dropped for the slow client only
+    if (connected_socket != nullptr && IsBlocked(*connected_socket)) {
+      first = socket_end;
+      continue;
+    }
+
+    const std::size_t sent_end = Send(
+        connected_socket != nullptr ? *connected_socket : socket_, first, socket_end);
+    end += sent_end - socket_end;
+    first = sent_end;
+  }
+
+  return end;
+}
+
+std::size_t RtpEgress::Send(sock::Socket &socket, std::size_t first,
+                            std::size_t end) {
+  int retries = 0;
+
+  while (first < end) {
+    const sock::BatchSendResult result = socket.SendBatch(batch_, first, end);
+    first = result.sent;
+    if (result.error == 0) {
+      break;
+    }
+
+    // Kernel or device can't segment, so all next datagrams are sent as is.
+    // Segments are sent in place of the datagram to keep packets order
+    const bool segmented = (batch_.GetSegmentSize(first) != 0);
+    if (segmented && (result.error == EINVAL || result.error == EIO)) {
+      if (segmentation_enabled_) {
+        std::cout << "UDP segmentation is disabled: " << strerror(result.error)
+                  << std::endl;
+      }
+      segmentation_enabled_ = false;
+      end += batch_.Split(first) - 1;
+      continue;
+    }
+
+    // Connected socket got ICMP error from its client. Session expires by
+    // itself, if client is gone
+    if (result.error == ECONNREFUSED) {
+      ++first;
+      retries = 0;
+      continue;
+    }
+
+    // Slow client mustn't hold the other ones
+    if (result.error == EAGAIN && &socket != &socket_) {
+      blocked_sockets_.push_back(&socket);
+      return end;
+    }
+
+    const bool temporary = (result.error == ENOBUFS || result.error == EAGAIN);
+    if (temporary && retries < kMaxRetries) {
+      ++retries;
+      std::this_thread::yield();
+      continue;
+    }
+
+    ++failed_datagrams_;
+    last_send_error_ = result.error;
+    ++first;
+    retries = 0;
+  }
+
+  return end;
+}
+
+} // namespace pipeline
@@ -0,0 +1,205 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <vector>
+#include <chrono>
+
+#include "byte.h"
+#include "span.h"
+#include "sock/server_socket.h"
+#include "sock/address.h"
+#include "sock/datagram_batch.h"
+
+namespace pipeline {
+
+/**
+ * @brief UDP egress shared by all RTP streams
+ * @details Streams queue datagrams of the frame and all of them are sent
+ * together with a few sendmmsg() calls. Frames are split by kernel with UDP
+ * GSO when possible, falling back to one datagram per packet. Datagrams can
+ * be paced either by kernel (SO_TXTIME) or by sleeping in Flush(). Datagrams
+ * are sent from the egress socket or from connected sockets of the sessions.
+ * Used only from the pipeline send stage thread
+ */
+class RtpEgress {
+ public:
+  /**
+   * @brief Egress configuration
+   */
+  struct Config {
+    //! If true, kernel holds datagrams until their send times (SO_TXTIME).
+    //! Needs fq qdisc on the outgoing interface. Otherwise Flush() sleeps
+    bool kernel_pacing;
+    int port; //!< Local port, RTP is sent from
+    sock::MulticastOptions multicast; //!< Options of multicast datagrams
+  };
+
+  /**
+   * @brief Construct a new RtpEgress object
+   * @details Falls back to pacing in Flush(), if kernel doesn't support SO_TXTIME
+   * @throws sock::BindError if port can't be bound
+   * @throws sock::SocketException if multicast options can't be set
+   *
+   * @param config Egress configuration
+   */
+  explicit RtpEgress(const Config &config);
+
+  /**
+   * @brief Prepare connected socket to send datagrams through the egress
+   * @details Passes send times to kernel, if egress uses kernel pacing
+   *
+   * @param socket Connected UDP socket
+   */
+  void AttachSocket(sock::Socket &socket);
+
+  /**
+   * @brief Queue datagram
+   * @details Data and address must stay alive until Flush()
+   *
+   * @param address Destination
+   * @param parts Parts of the datagram in order
+   */
+  void Queue(const sock::Address &address, Span<const Span<const Byte>> parts);
+
+  /**
+   * @brief Queue datagrams of fixed size
+   * @details Uses UDP GSO if supported, so kernel splits large buffers into
+   * datagrams. Otherwise every datagram is queued separately. Data and
+   * address must stay alive until Flush()
+   *
+   * @param address Destination
+   * @param parts Parts of all datagrams in order. Datagram borders must
+   * match part borders
+   * @param segment_size Size of every datagram except the last one
+   * @param pacing_window Time to spread datagrams over, starting from now.
+   * Zero sends them at once
+   */
+  void QueueSegments(const sock::Address &address,
+                     Span<const Span<const Byte>> parts, uint16_t segment_size,
+                     std::chrono::nanoseconds pacing_window =
+                         std::chrono::nanoseconds::zero());
+
+  /**
+   * @brief Queue datagrams of fixed size to be sent through connected socket
+   * @details Same as QueueSegments() with address, but socket is used
+   * instead of the egress one. Socket must be attached with AttachSocket()
+   *
+   * @param socket Connected socket
+   * @param parts Parts of all datagrams in order. Datagram borders must
+   * match part borders
+   * @param segment_size Size of every datagram except the last one
+   * @param pacing_window Time to spread datagrams over, starting from now.
+   * Zero sends them at once
+   */
+  void QueueSegments(sock::Socket &socket,
+                     Span<const Span<const Byte>> parts, uint16_t segment_size,
+                     std::chrono::nanoseconds pacing_window =
+                         std::chrono::nanoseconds::zero());
+
+  /**
+   * @brief Send all queued datagrams
+   * @details Datagrams, which can't be delivered to their destination, are
+   * skipped, so one broken destination doesn't affect the others. The rest
+   * of datagrams of the connected socket with full send buffer are skipped
+   * too. Without kernel pacing returns after the last datagram send time
+   */
+  void Flush();
+
+  /**
+   * @brief Check if datagrams of the socket were skipped by the last Flush(),
+   * because its send buffer was full
+   *
+   * @param socket Connected socket
+   * @return true If some datagrams of the socket weren't sent
+   */
+  bool IsBlocked(const sock::Socket &socket) const;
+
+ private:
+  sock::ServerSocket socket_; //!< Socket to send datagrams from
+  sock::DatagramBatch batch_; //!< Queued datagrams
+  bool segmentation_enabled_; //!< True, if UDP GSO is used
+  bool kernel_pacing_; //!< True, if send times are passed to kernel
+  //! Connected sockets, which send buffers got full during the last Flush()
+  std::vector<const sock::Socket *> blocked_sockets_;
+  //! Number of datagrams, which failed to send during the current Flush()
+  std::size_t failed_datagrams_;
+  int last_send_error_; //!< errno of the last failed datagram
+
+  /**
+   * @brief Queue datagrams of fixed size to the address or connected socket
+   *
+   * @param address Destination or nullptr
+   * @param socket Connected socket or nullptr
+   * @param parts Parts of all datagrams in order
+   * @param segment_size Size of every datagram except the last one
+   * @param pacing_window Time to spread datagrams over
+   */
+  void QueueSegments(const sock::Address *address, sock::Socket *socket,
+                     Span<const Span<const Byte>> parts, uint16_t segment_size,
+                     std::chrono::nanoseconds pacing_window);
+
+  /**
+   * @brief Add datagram to the batch for the address or connected socket
+   *
+   * @param address Destination or nullptr
+   * @param socket Connected socket or nullptr
+   * @param parts Parts of the datagram in order
+   * @param segment_size GSO segment size or 0
+   * @param send_time Send time or 0
+   */
+  void Add(const sock::Address *address, sock::Socket *socket,
+           Span<const Span<const Byte>> parts, uint16_t segment_size = 0,
+           uint64_t send_time = 0);
+
+  /**
+   * @brief Send datagrams of the batch in range
+   * @details Consecutive datagrams of one socket are sent together
+   *
+   * @param first Index of the first datagram to send
+   * @param end Index after the last datagram to send
+   * @return Index after the last sent datagram. Greater than end, if
+   * segmented datagrams were split
+   */
+  std::size_t Send(std::size_t first, std::size_t end);
+
+  /**
+   * @brief Send datagrams of the batch in range through one socket
+   * @details Retries temporary errors and skips datagrams, which can't be
+   * sent. Segmented datagrams are split in place, if kernel refuses to
+   * segment them
+   *
+   * @param socket Socket of all datagrams in range
+   * @param first Index of the first datagram to send
+   * @param end Index after the last datagram to send
+   * @return Index after the last sent datagram. Greater than end, if
+   * segmented datagrams were split
+   */
+  std::size_t Send(sock::Socket &socket, std::size_t first, std::size_t end);
+};
+
+} // namespace pipeline
@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "rtp_sink.h"
+
+#include <utility>
+
+namespace pipeline {
+
+UdpSink::UdpSink(const std::string &client_ip, const int client_port,
+                 std::shared_ptr<RtpEgress> egress) :
+client_address_(sock::Address(client_ip, client_port)),
+transport_(),
+egress_(std::move(egress)),
+send_buffer_size_() {}
+
+UdpSink::UdpSink(std::shared_ptr<UdpTransport> transport,
+                 std::shared_ptr<RtpEgress> egress) :
+client_address_(),
+transport_(std::move(transport)),
+egress_(std::move(egress)),
+send_buffer_size_(transport_->GetRtpSocket().GetSendBufferSize()) {
+  egress_->AttachSocket(transport_->GetRtpSocket());
+}
+
+std::optional<QueueOccupancy> UdpSink::GetQueueOccupancy() const {
+  if (!transport_ || !send_buffer_size_) {
+    return std::nullopt;
+  }
+
+  const std::optional<std::size_t> queued_bytes =
+      transport_->GetRtpSocket().GetQueuedSendBytes();
+  if (!queued_bytes) {
+    return std::nullopt;
+  }
+  return QueueOccupancy{*queued_bytes, *send_buffer_size_};
+}
+
+bool UdpSink::QueueFrame(const EncodedFramePtr &,
+                         Span<const Span<const Byte>> parts,
+                         const std::size_t packet_size,
+                         const std::chrono::nanoseconds pacing_window) {
+  if (transport_) {
+    egress_->QueueSegments(transport_->GetRtpSocket(), parts, packet_size,
+                           pacing_window);
+  } else {
+    egress_->QueueSegments(*client_address_, parts, packet_size, pacing_window);
+  }
+  return true;
+}
+
+bool UdpSink::Flush() {
+  egress_->Flush();
+  return !transport_ || !egress_->IsBlocked(transport_->GetRtpSocket());
+}
+
+InterleavedSink::InterleavedSink(std::shared_ptr<sock::SharedOutput> output,
+                                 const uint8_t channel) :
+output_(std::move(output)),
+channel_(channel),
+headers_(),
+parts_() {}
+
+std::optional<QueueOccupancy> InterleavedSink::GetQueueOccupancy() const {
+  return QueueOccupancy{output_->GetSize(), output_->GetCapacity()};
+}
+
+bool InterleavedSink::QueueFrame(const EncodedFramePtr &frame,
+                                 Span<const Span<const Byte>> parts, std::size_t,
+                                 std::chrono::nanoseconds) {
+  // Parts come in header and payload pairs
+  const std::size_t packet_count = parts.size() / 2;
+  headers_.clear();
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    const std::size_t size = parts[2 * i].size() + parts[2 * i + 1].size();
+    headers_.push_back(rtsp::BuildInterleavedHeader(channel_,
+                                                    static_cast<uint16_t>(size)));
+  }
+
+  // headers_ is filled before taking spans of its elements
+  parts_.clear();
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    parts_.push_back(headers_[i]);
+    parts_.push_back(parts[2 * i]);
+    parts_.push_back(parts[2 * i + 1]);
+  }
+
+  // Frame, which doesn't fit, is dropped as a whole, so client gets only
+  // complete frames
+  return output_->Write(parts_, 3, frame);
+}
+
+bool InterleavedSink::Flush() {
+  return true;
+}
+
+} // namespace pipeline
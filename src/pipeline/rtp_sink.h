@@ -0,0 +1,185 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <chrono>
+
+#include "byte.h"
+#include "span.h"
+#include "sock/address.h"
+#include "sock/shared_output.h"
+#include "rtsp/interleaved.h"
+#include "pipeline.h"
+#include "rtp_egress.h"
+#include "udp_transport.h"
+
+namespace pipeline {
+
+/**
+ * @brief Occupancy of the transport queue of one stream
+ */
+struct QueueOccupancy {
+  std::size_t queued_bytes; //!< Bytes accepted by the transport, but not sent yet
+  std::size_t capacity; //!< Max number of bytes the transport accepts
+};
+
+/**
+ * @brief Transport delivering RTP packets of one stream to its client
+ * @details Used only from the pipeline send stage thread
+ */
+class RtpSink {
+ public:
+  virtual ~RtpSink() = default;
+
+  /**
+   * @brief Get occupancy of the transport queue of this stream
+   *
+   * @return Occupancy if the stream has its own queue and it can be measured
+   */
+  virtual std::optional<QueueOccupancy> GetQueueOccupancy() const = 0;
+
+  /**
+   * @brief Queue packets of the frame
+   * @details Headers must stay alive until Flush(). Payloads may be kept
+   * longer by holding the frame
+   *
+   * @param frame Frame, which payloads point into
+   * @param parts Header and payload of every packet in order
+   * @param packet_size Size of every packet except the last one
+   * @param pacing_window Time to spread packets over, starting from now.
+   * Transport may ignore it
+   * @return true If packets are queued
+   * @return false If transport dropped the whole frame
+   */
+  virtual bool QueueFrame(const EncodedFramePtr &frame,
+                          Span<const Span<const Byte>> parts, std::size_t packet_size,
+                          std::chrono::nanoseconds pacing_window) = 0;
+
+  /**
+   * @brief Send all queued packets
+   *
+   * @return true If all packets of the queued frame were passed to the kernel
+   * @return false If the rest of the frame was dropped, because the
+   * transport queue got full
+   */
+  virtual bool Flush() = 0;
+};
+
+/**
+ * @brief Sink sending packets as UDP datagrams through the shared egress
+ * @details Datagrams are sent either from the egress socket to the address
+ * or from the connected socket of the session
+ */
+class UdpSink : public RtpSink {
+ public:
+  /**
+   * @brief Construct a new UdpSink object sending from the egress socket
+   *
+   * @param client_ip Client ip address
+   * @param client_port Client RTP port
+   * @param egress Egress to send packets through
+   */
+  UdpSink(const std::string &client_ip, int client_port,
+          std::shared_ptr<RtpEgress> egress);
+
+  /**
+   * @brief Construct a new UdpSink object sending from the session socket
+   *
+   * @param transport Sockets of the session
+   * @param egress Egress to send packets through
+   */
+  UdpSink(std::shared_ptr<UdpTransport> transport, std::shared_ptr<RtpEgress> egress);
+
+  /**
+   * @brief Get occupancy of the kernel send queue of the session socket
+   *
+   * @return Occupancy if session socket is used. Egress socket is shared by
+   * streams, so its queue isn't measured
+   */
+  std::optional<QueueOccupancy> GetQueueOccupancy() const override;
+
+  bool QueueFrame(const EncodedFramePtr &frame, Span<const Span<const Byte>> parts,
+                  std::size_t packet_size,
+                  std::chrono::nanoseconds pacing_window) override;
+
+  bool Flush() override;
+
+ private:
+  //! Resolved client RTP address. Empty, if session socket is used
+  const std::optional<sock::Address> client_address_;
+  const std::shared_ptr<UdpTransport> transport_; //!< Sockets of the session or nullptr
+  const std::shared_ptr<RtpEgress> egress_; //!< Egress to send packets through
+  //! Size of the send buffer of the session socket
+  const std::optional<std::size_t> send_buffer_size_;
+};
+
+/**
+ * @brief Sink sending packets over RTSP connection of the client
+ * @details Every packet is prefixed with interleaved data header. Packets
+ * of the frame are queued to the connection output at once, so reactor
+ * sends them with a few calls. Headers are copied and payloads are
+ * referenced, holding the frame until they are sent. If client doesn't read
+ * fast enough and the output is full, the whole frame is dropped. Pacing is
+ * left to TCP
+ */
+class InterleavedSink : public RtpSink {
+ public:
+  /**
+   * @brief Construct a new InterleavedSink object
+   *
+   * @param output Output of the client RTSP connection
+   * @param channel Interleaved channel of RTP
+   */
+  InterleavedSink(std::shared_ptr<sock::SharedOutput> output, uint8_t channel);
+
+  /**
+   * @brief Get occupancy of the connection output
+   * @details Output grows, when kernel buffer of the connection is full
+   *
+   * @return Data queued to the output, which reactor hasn't taken yet
+   */
+  std::optional<QueueOccupancy> GetQueueOccupancy() const override;
+
+  bool QueueFrame(const EncodedFramePtr &frame, Span<const Span<const Byte>> parts,
+                  std::size_t packet_size,
+                  std::chrono::nanoseconds pacing_window) override;
+
+  bool Flush() override;
+
+ private:
+  const std::shared_ptr<sock::SharedOutput> output_; //!< Output of the connection
+  const uint8_t channel_; //!< Interleaved channel of RTP
+  std::vector<rtsp::InterleavedHeader> headers_; //!< Headers of the frame packets
+  std::vector<Span<const Byte>> parts_; //!< Parts of the frame packets with headers
+};
+
+} // namespace pipeline
@@ -0,0 +1,341 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "rtp_streamer.h"
+
+#include <random>
+#include <utility>
+#include <algorithm>
+
+#include "rtp/packet.h"
+#include "rtp/mjpeg/packet.h"
+
+namespace {
+
+//! RTP clock rate of video
+const uint32_t kVideoClockRate = 90'000;
+
+/**
+ * @brief Generate random 32-bit number
+ *
+ * @return Random number
+ */
+uint32_t GenerateRandom() {
+  static thread_local std::mt19937 mersenne(std::random_device{}());
+  return mersenne();
+}
+
+} // namespace
+
+namespace pipeline {
+
+RtpStreamer::RtpStreamer(const StreamConfig &config,
+                         std::shared_ptr<FramePacketizer> packetizer,
+                         std::unique_ptr<RtpSink> sink) :
+bytes_per_packet_(config.bytes_per_packet),
+frame_interval_(config.frame_interval),
+max_queued_frames_(config.max_queued_frames),
+max_retransmits_per_frame_(config.max_retransmits_per_frame),
+pacing_fraction_(std::clamp(config.pacing_fraction, 0.0, kMaxPacingFraction)),
+packetizer_(std::move(packetizer)),
+sink_(std::move(sink)),
+initial_timestamp_(GenerateRandom()),
+synchronization_source_(GenerateRandom()),
+sequence_number_(GenerateRandom()),
+first_capture_time_(),
+parts_(),
+queued_frame_sizes_(config.max_queued_frames),
+next_queued_frame_(0),
+queued_frames_count_(0),
+frame_queued_(false),
+headers_arena_(rtp::mjpeg::kHeadersSize),
+history_(config.history_frames),
+lost_packets_(),
+avg_latency_(0),
+frame_counter_(0),
+stats_mutex_(),
+last_timestamp_(0),
+last_capture_time_(),
+packet_count_(0),
+octet_count_(0),
+dropped_frames_(0),
+retransmitted_packets_(0),
+requested_packets_(),
+reception_stats_(),
+last_report_time_() {
+  // Requests are swapped between these, so no allocations happen later
+  lost_packets_.reserve(max_retransmits_per_frame_);
+  requested_packets_.reserve(max_retransmits_per_frame_);
+}
+
+void RtpStreamer::OnFrame(const EncodedFramePtr &frame) {
+  if (!first_capture_time_) {
+    first_capture_time_ = frame->capture_time;
+  }
+
+  // Timestamp is derived from capture time, so dropped frames don't break it
+  const auto since_first_frame = frame->capture_time - first_capture_time_.value();
+  const uint32_t timestamp = initial_timestamp_ + static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(since_first_frame).count() *
+      kVideoClockRate / 1'000'000);
+
+  // History advances with dropped frames too, so it never pins frames older
+  // than the last ones, which the pipeline pool accounts for
+  history_.NextFrame();
+
+  // Frame is split once for all streams, only headers are copied and patched
+  const PacketizedFrame &packets = packetizer_->Packetize(frame, bytes_per_packet_);
+  const std::size_t packet_count = packets.fragments.size();
+
+  std::size_t frame_size = 0;
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    frame_size += rtp::mjpeg::kHeadersSize + packets.fragments[i].data.size();
+  }
+  // Sequence numbers are not taken by the dropped frame, so client sees only
+  // a gap in timestamps instead of lost packets
+  if (!CanQueue(frame_size)) {
+    std::lock_guard lock(stats_mutex_);
+    ++dropped_frames_;
+    return;
+  }
+  QueueRetransmissions();
+
+  const uint16_t first_sequence_number = sequence_number_;
+  headers_arena_.Clear();
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    const Span<const Byte> shared_headers = packets.headers.GetPacket(i);
+    const Span<Byte> headers = headers_arena_.Allocate();
+    std::copy(shared_headers.begin(), shared_headers.end(), headers.begin());
+    rtp::PatchHeader(headers, sequence_number_++, timestamp, synchronization_source_);
+    headers_arena_.Commit(shared_headers.size());
+  }
+
+  // Payload goes to the kernel right from the encoded frame, which is kept
+  // alive by the publisher until Flush()
+  parts_.clear();
+  std::size_t octet_count = 0;
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    parts_.push_back(headers_arena_.GetPacket(i));
+    parts_.push_back(packets.fragments[i].data);
+    octet_count += rtp::mjpeg::kJpegHeaderSize + packets.fragments[i].data.size();
+  }
+  const auto pacing_window = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      frame_interval_ * pacing_fraction_.load());
+  if (!sink_->QueueFrame(frame, parts_, rtp::mjpeg::kHeadersSize + bytes_per_packet_,
+                         pacing_window)) {
+    std::lock_guard lock(stats_mutex_);
+    ++dropped_frames_;
+    return;
+  }
+
+  frame_queued_ = true;
+
+  for (std::size_t i = 0; i < packet_count; ++i) {
+    history_.Add(frame, headers_arena_.GetPacket(i), packets.fragments[i].data,
+                 static_cast<uint16_t>(first_sequence_number + i));
+  }
+
+  if (!queued_frame_sizes_.empty()) {
+    queued_frame_sizes_[next_queued_frame_] = frame_size;
+    next_queued_frame_ = (next_queued_frame_ + 1) % queued_frame_sizes_.size();
+    queued_frames_count_ = std::min(queued_frames_count_ + 1,
+                                    queued_frame_sizes_.size());
+  }
+
+  {
+    std::lock_guard lock(stats_mutex_);
+    last_timestamp_ = timestamp;
+    last_capture_time_ = frame->capture_time;
+    packet_count_ += packet_count;
+    octet_count_ += octet_count;
+  }
+
+  auto dur = std::chrono::steady_clock::now() - frame->capture_time;
+  uint32_t time_diff = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+  avg_latency_ = (avg_latency_ * frame_counter_ + time_diff) / (frame_counter_ + 1);
+  ++frame_counter_;
+}
+
+bool RtpStreamer::CanQueue(const std::size_t frame_size) const {
+  const std::optional<QueueOccupancy> occupancy = sink_->GetQueueOccupancy();
+  if (!occupancy) {
+    return true;
+  }
+  // Kernel would accept only a part of the frame
+  if (occupancy->queued_bytes + frame_size > occupancy->capacity) {
+    return false;
+  }
+
+  // Partially sent frame is still counted. Kernel accounts datagrams with
+  // overhead, so the estimate errs to more frames
+  std::size_t queued_frames = 0;
+  std::size_t remaining_bytes = occupancy->queued_bytes;
+  const std::size_t ring_size = queued_frame_sizes_.size();
+  for (std::size_t i = 1; i <= queued_frames_count_ && remaining_bytes > 0; ++i) {
+    const std::size_t size = queued_frame_sizes_[(next_queued_frame_ + ring_size - i) %
+                                                 ring_size];
+    remaining_bytes -= std::min(remaining_bytes, size);
+    ++queued_frames;
+  }
+  return queued_frames < max_queued_frames_;
+}
+
+void RtpStreamer::QueueRetransmissions() {
+  lost_packets_.clear();
+  {
+    std::lock_guard lock(stats_mutex_);
+    std::swap(lost_packets_, requested_packets_);
+  }
+
+  uint64_t retransmitted_packets = 0;
+  for (const uint16_t sequence_number : lost_packets_) {
+    const std::optional<PacketHistory::Entry> entry = history_.Find(sequence_number);
+    if (!entry || entry->packet.retransmitted) {
+      continue;
+    }
+
+    const Span<const Byte> parts[] = {entry->packet.headers, entry->packet.payload};
+    if (!sink_->QueueFrame(entry->frame, parts, parts[0].size() + parts[1].size(),
+                           std::chrono::nanoseconds::zero())) {
+      break;
+    }
+    entry->packet.retransmitted = true;
+    ++retransmitted_packets;
+  }
+
+  std::lock_guard lock(stats_mutex_);
+  retransmitted_packets_ += retransmitted_packets;
+}
+
+void RtpStreamer::Flush() {
+  // Sink reports state of the last flush, which may be of an earlier frame
+  const bool sent = sink_->Flush();
+  if (frame_queued_ && !sent) {
+    std::lock_guard lock(stats_mutex_);
+    ++dropped_frames_;
+  }
+  frame_queued_ = false;
+}
+
+uint32_t RtpStreamer::GetSynchronizationSource() const {
+  return synchronization_source_;
+}
+
+std::optional<rtcp::SenderReport> RtpStreamer::BuildSenderReport() const {
+  const auto wallclock_now = std::chrono::system_clock::now();
+  const auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard lock(stats_mutex_);
+  if (packet_count_ == 0) {
+    return std::nullopt;
+  }
+
+  // RTP timestamp of the current moment on the same clock as frames
+  const auto since_last_frame = std::chrono::duration_cast<std::chrono::microseconds>(
+      now - last_capture_time_).count();
+  rtcp::SenderReport report;
+  report.synchronization_source = synchronization_source_;
+  report.ntp_timestamp = rtcp::ToNtpTimestamp(wallclock_now);
+  report.rtp_timestamp = last_timestamp_ + static_cast<uint32_t>(
+      since_last_frame * kVideoClockRate / 1'000'000);
+  report.packet_count = packet_count_;
+  report.octet_count = octet_count_;
+
+  return report;
+}
+
+void RtpStreamer::OnReceptionReport(const rtcp::ReportBlock &block,
+                                    const uint64_t arrival_time) {
+  const rtcp::ReceptionStats stats = rtcp::ToReceptionStats(block, kVideoClockRate,
+                                                            arrival_time);
+  std::lock_guard lock(stats_mutex_);
+  reception_stats_ = stats;
+  last_report_time_ = std::chrono::steady_clock::now();
+}
+
+void RtpStreamer::OnNack(const rtcp::GenericNack &nack) {
+  if (history_.GetCapacity() == 0) {
+    return;
+  }
+  const std::size_t max_requests = max_retransmits_per_frame_;
+
+  // Packet ID and up to 16 following packets marked in the bitmask
+  std::lock_guard lock(stats_mutex_);
+  if (requested_packets_.size() < max_requests) {
+    requested_packets_.push_back(nack.packet_id);
+  }
+  for (uint16_t i = 0; i < 16; ++i) {
+    if ((nack.lost_bitmask & (1 << i)) && requested_packets_.size() < max_requests) {
+      requested_packets_.push_back(static_cast<uint16_t>(nack.packet_id + i + 1));
+    }
+  }
+}
+
+std::chrono::steady_clock::time_point RtpStreamer::GetLastReportTime() const {
+  std::lock_guard lock(stats_mutex_);
+  return last_report_time_;
+}
+
+std::optional<rtcp::ReceptionStats> RtpStreamer::GetReceptionStats() const {
+  std::lock_guard lock(stats_mutex_);
+  return reception_stats_;
+}
+
+uint32_t RtpStreamer::GetPacketCount() const {
+  std::lock_guard lock(stats_mutex_);
+  return packet_count_;
+}
+
+uint32_t RtpStreamer::GetOctetCount() const {
+  std::lock_guard lock(stats_mutex_);
+  return octet_count_;
+}
+
+std::size_t RtpStreamer::GetBytesPerPacket() const {
+  return bytes_per_packet_;
+}
+
+void RtpStreamer::SetPacingFraction(const double pacing_fraction) {
+  pacing_fraction_ = std::clamp(pacing_fraction, 0.0, kMaxPacingFraction);
+}
+
+double RtpStreamer::GetPacingFraction() const {
+  return pacing_fraction_;
+}
+
+uint64_t RtpStreamer::GetDroppedFrames() const {
+  std::lock_guard lock(stats_mutex_);
+  return dropped_frames_;
+}
+
+uint64_t RtpStreamer::GetRetransmittedPackets() const {
+  std::lock_guard lock(stats_mutex_);
+  return retransmitted_packets_;
+}
+
+double RtpStreamer::GetAverageLatency() const {
+  return avg_latency_;
+}
+
+} // namespace pipeline
@@ -0,0 +1,269 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+
+#include "span.h"
+#include "rtp/packet_arena.h"
+#include "rtcp/packet.h"
+#include "frame_publisher.h"
+#include "frame_packetizer.h"
+#include "rtp_sink.h"
+#include "packet_history.h"
+
+namespace pipeline {
+
+//! Max part of the frame interval to spread packets over. The rest is left
+//! for the other streams and retransmissions, so the send stage keeps up
+const double kMaxPacingFraction = 0.8;
+
+/**
+ * @brief Parameters of the RTP stream negotiated with the client
+ */
+struct StreamConfig {
+  std::size_t bytes_per_packet; //!< Number of JPEG bytes in one packet
+  std::chrono::nanoseconds frame_interval; //!< Time between frames of the source
+  //! Part of the frame interval in [0, 0.8] range to spread packets of the
+  //! frame over. 0 sends them at once
+  double pacing_fraction;
+  //! Max number of frames waiting in the transport queue of the stream. The
+  //! next frames are dropped, until the queue goes down
+  std::size_t max_queued_frames;
+  //! Number of the last frames, which packets are kept for retransmission.
+  //! 0 disables retransmission
+  std::size_t history_frames;
+  //! Max number of packets retransmitted before one frame, so retransmission
+  //! can't starve fresh frames
+  std::size_t max_retransmits_per_frame;
+};
+
+/**
+ * @brief Subscriber sending frames to one client as MJPEG over RTP
+ * @details If client or network can't keep up, the transport queue of the
+ * stream grows. Then new frames are dropped as a whole before any work on
+ * them, so a slow client neither gets partial frames nor delays the others.
+ * Packets lost by the client are retransmitted on generic NACK before the
+ * next frame with the same sequence numbers
+ */
+class RtpStreamer : public FrameSubscriber {
+ public:
+  /**
+   * @brief Construct a new RtpStreamer object
+   * @details Initial sequence number, timestamp and SSRC are random
+   *
+   * @param config Stream parameters
+   * @param packetizer Packetizer shared with other streams of the same frames
+   * @param sink Transport to send packets through
+   */
+  RtpStreamer(const StreamConfig &config,
+              std::shared_ptr<FramePacketizer> packetizer,
+              std::unique_ptr<RtpSink> sink);
+
+  void OnFrame(const EncodedFramePtr &frame) override;
+
+  void Flush() override;
+
+  /**
+   * @brief Get SSRC of the stream
+   *
+   * @return Synchronization source identifier
+   */
+  uint32_t GetSynchronizationSource() const;
+
+  /**
+   * @brief Get number of JPEG bytes in one packet
+   *
+   * @return Max payload size without headers
+   */
+  std::size_t GetBytesPerPacket() const;
+
+  /**
+   * @brief Set part of the frame interval to spread packets of the frame over
+   * @details Thread-safe. Takes effect from the next frame
+   *
+   * @param pacing_fraction Fraction clamped to [0, 0.8] range. 0 disables pacing
+   */
+  void SetPacingFraction(double pacing_fraction);
+
+  /**
+   * @brief Get part of the frame interval to spread packets of the frame over
+   *
+   * @return Fraction in [0, 0.8] range
+   */
+  double GetPacingFraction() const;
+
+  /**
+   * @brief Build sender report of the stream for the current moment
+   * @details Thread-safe
+   *
+   * @return Report if any frame was sent
+   */
+  std::optional<rtcp::SenderReport> BuildSenderReport() const;
+
+  /**
+   * @brief Handle reception report about the stream from the client
+   * @details Thread-safe
+   *
+   * @param block Report block about this stream
+   * @param arrival_time NTP timestamp of the report arrival
+   */
+  void OnReceptionReport(const rtcp::ReportBlock &block, uint64_t arrival_time);
+
+  /**
+   * @brief Request retransmission of packets reported lost by the client
+   * @details Thread-safe. Packets are sent before the next frame, if they
+   * are still in the history
+   *
+   * @param nack Generic NACK item about this stream
+   */
+  void OnNack(const rtcp::GenericNack &nack);
+
+  /**
+   * @brief Get the last reception statistics reported by the client
+   * @details Thread-safe
+   *
+   * @return Statistics if client has sent any report
+   */
+  std::optional<rtcp::ReceptionStats> GetReceptionStats() const;
+
+  /**
+   * @brief Get arrival time of the last reception report
+   * @details Thread-safe
+   *
+   * @return Arrival time or default time point if there were no reports
+   */
+  std::chrono::steady_clock::time_point GetLastReportTime() const;
+
+  /**
+   * @brief Get number of sent RTP packets
+   *
+   * @return Packet count
+   */
+  uint32_t GetPacketCount() const;
+
+  /**
+   * @brief Get number of sent RTP payload bytes
+   *
+   * @return Octet count
+   */
+  uint32_t GetOctetCount() const;
+
+  /**
+   * @brief Get number of frames dropped, because transport couldn't keep up
+   *
+   * @return Dropped frames count
+   */
+  uint64_t GetDroppedFrames() const;
+
+  /**
+   * @brief Get number of packets retransmitted on client requests
+   *
+   * @return Retransmitted packets count
+   */
+  uint64_t GetRetransmittedPackets() const;
+
+  /**
+   * @brief Get average time between frame capturing and its sending
+   *
+   * @return Average time in milliseconds
+   */
+  double GetAverageLatency() const;
+
+ private:
+  const std::size_t bytes_per_packet_; //!< Number of JPEG bytes in one packet
+  const std::chrono::nanoseconds frame_interval_; //!< Time between frames
+  const std::size_t max_queued_frames_; //!< Max frames in the transport queue
+  //! Max number of packets retransmitted before one frame
+  const std::size_t max_retransmits_per_frame_;
+  std::atomic<double> pacing_fraction_; //!< Part of frame interval to send frame in
+  //! Packetizer shared with other streams of the same frames
+  const std::shared_ptr<FramePacketizer> packetizer_;
+  const std::unique_ptr<RtpSink> sink_; //!< Transport to send packets through
+  const uint32_t initial_timestamp_; //!< RTP timestamp of the first frame
+  const uint32_t synchronization_source_; //!< SSRC of the stream
+  uint16_t sequence_number_; //!< Sequence number of the next packet
+  //! Capture time of the first sent frame
+  std::optional<std::chrono::steady_clock::time_point> first_capture_time_;
+  std::vector<Span<const Byte>> parts_; //!< Headers and payloads of the frame being sent
+  //! Ring of sizes of the last max_queued_frames_ queued frames
+  std::vector<std::size_t> queued_frame_sizes_;
+  std::size_t next_queued_frame_; //!< Index of the ring slot for the next frame
+  std::size_t queued_frames_count_; //!< Number of filled ring slots
+  bool frame_queued_; //!< True, if the last frame was queued to the sink
+  //! Packet headers of the frame being sent, patched for this stream
+  rtp::PacketArena headers_arena_;
+  PacketHistory history_; //!< Packets of the last frames for retransmission
+  std::vector<uint16_t> lost_packets_; //!< Sequence numbers being retransmitted
+  std::atomic<double> avg_latency_; //!< Average time from capturing to sending in ms
+  uint64_t frame_counter_; //!< Number of sent frames
+
+  mutable std::mutex stats_mutex_; //!< Mutex to protect members below
+  uint32_t last_timestamp_; //!< RTP timestamp of the last sent frame
+  //! Capture time of the last sent frame
+  std::chrono::steady_clock::time_point last_capture_time_;
+  uint32_t packet_count_; //!< Number of sent RTP packets
+  uint32_t octet_count_; //!< Number of sent RTP payload bytes
+  //! Number of frames dropped whole or partially due to full queue
+  uint64_t dropped_frames_;
+  uint64_t retransmitted_packets_; //!< Number of retransmitted packets
+  //! Sequence numbers of packets reported lost since the last frame. At most
+  //! max_retransmits_per_frame_, the others are ignored
+  std::vector<uint16_t> requested_packets_;
+  //! The last reception statistics reported by the client
+  std::optional<rtcp::ReceptionStats> reception_stats_;
+  //! Arrival time of the last reception report
+  std::chrono::steady_clock::time_point last_report_time_;
+
+  /**
+   * @brief Check if the frame can be queued to the transport
+   * @details Frames, which are still in the queue, are found by walking
+   * sizes of the last frames from the newest one. Frame must also fit into
+   * the queue as a whole
+   *
+   * @param frame_size Size of all packets of the frame
+   * @return true If transport queue has space for the frame
+   * @return false If the frame must be dropped
+   */
+  bool CanQueue(std::size_t frame_size) const;
+
+  /**
+   * @brief Queue packets requested by the client, which are still in history
+   * @details Every packet is retransmitted at most once. Queued packets
+   * stay in history until the next frame, so they outlive Flush()
+   */
+  void QueueRetransmissions();
+};
+
+} // namespace pipeline
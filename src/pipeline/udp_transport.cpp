@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "udp_transport.h"
+
+#include <utility>
+
+#include "sock/exception.h"
+
+namespace pipeline {
+
+PortPool::PortPool(const int first_port, const std::size_t pairs_count) :
+pairs_count_(pairs_count),
+mutex_(),
+free_ports_() {
+  for (std::size_t i = 0; i < pairs_count; ++i) {
+    free_ports_.push_back(first_port + static_cast<int>(2 * i));
+  }
+}
+
+std::optional<int> PortPool::Acquire() {
+  std::lock_guard lock(mutex_);
+  if (free_ports_.empty()) {
+    return std::nullopt;
+  }
+
+  const int port = free_ports_.front();
+  free_ports_.pop_front();
+  return port;
+}
+
+void PortPool::Release(const int port) {
+  std::lock_guard lock(mutex_);
+  free_ports_.push_back(port);
+}
+
+std::size_t PortPool::GetPairsCount() const {
+  return pairs_count_;
+}
+
+UdpTransport::UdpTransport(std::shared_ptr<PortPool> pool,
+                           const std::string &client_ip,
+                           const std::pair<int, int> client_ports,
+                           const bool rtcp_mux) :
+pool_(std::move(pool)),
+server_port_(0),
+rtp_socket_(),
+rtcp_socket_(),
+has_error_(false) {
+  // Ports may be taken by other programs, so every pair is tried once
+  for (std::size_t attempt = 0; attempt < pool_->GetPairsCount(); ++attempt) {
+    const std::optional<int> port = pool_->Acquire();
+    if (!port) {
+      break;
+    }
+
+    try {
+      rtp_socket_.emplace(sock::Type::kUdp);
+      rtp_socket_->Bind(*port);
+      if (!rtcp_mux) {
+        rtcp_socket_.emplace(sock::Type::kUdp);
+        rtcp_socket_->Bind(*port + 1);
+      }
+      server_port_ = *port;
+      break;
+    } catch (const sock::BindError &) {
+      rtp_socket_.reset();
+      rtcp_socket_.reset();
+      pool_->Release(*port);
+    }
+  }
+  if (server_port_ == 0) {
+    throw sock::BindError("No free server ports");
+  }
+
+  const int rtcp_client_port = (rtcp_mux ? client_ports.first : client_ports.second);
+  if (!rtp_socket_->Connect(client_ip, client_ports.first) ||
+      (rtcp_socket_ && !rtcp_socket_->Connect(client_ip, rtcp_client_port))) {
+    pool_->Release(server_port_);
+    throw sock::SocketException("Can't connect to " + client_ip);
+  }
+}
+
+UdpTransport::~UdpTransport() {
+  // Sockets are closed before their ports can be taken again
+  rtp_socket_.reset();
+  rtcp_socket_.reset();
+  pool_->Release(server_port_);
+}
+
+std::pair<int, int> UdpTransport::GetServerPorts() const {
+  if (IsRtcpMuxed()) {
+    return {server_port_, server_port_};
+  }
+  return {server_port_, server_port_ + 1};
+}
+
+bool UdpTransport::IsRtcpMuxed() const {
+  return !rtcp_socket_;
+}
+
+sock::ClientSocket &UdpTransport::GetRtpSocket() {
+  return *rtp_socket_;
+}
+
+sock::ClientSocket &UdpTransport::GetRtcpSocket() {
+  return (rtcp_socket_ ? *rtcp_socket_ : *rtp_socket_);
+}
+
+std::optional<int> UdpTransport::GetPathMtu() const {
+  return rtp_socket_->GetPathMtu();
+}
+
+bool UdpTransport::MarkError() {
+  return !has_error_.exchange(true);
+}
+
+} // namespace pipeline
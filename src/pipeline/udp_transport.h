@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <utility>
+#include <memory>
+#include <optional>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+#include "sock/client_socket.h"
+
+namespace pipeline {
+
+/**
+ * @brief Pool of local port pairs for RTP and RTCP of sessions
+ * @details Pairs start at even ports. Released pairs are reused last, so
+ * late datagrams of a closed session don't reach the next one. Thread-safe
+ */
+class PortPool {
+ public:
+  /**
+   * @brief Construct a new PortPool object
+   *
+   * @param first_port The first even port of the range
+   * @param pairs_count Number of port pairs in the range
+   */
+  PortPool(int first_port, std::size_t pairs_count);
+
+  /**
+   * @brief Take free pair
+   *
+   * @return Even RTP port of the pair, RTCP port is the next one
+   * @return std::nullopt if all pairs are taken
+   */
+  std::optional<int> Acquire();
+
+  /**
+   * @brief Return pair to the pool
+   *
+   * @param port RTP port of the pair returned by Acquire()
+   */
+  void Release(int port);
+
+  /**
+   * @brief Get number of pairs in the range
+   *
+   * @return Number of pairs
+   */
+  std::size_t GetPairsCount() const;
+
+ private:
+  const std::size_t pairs_count_; //!< Number of pairs in the range
+  std::mutex mutex_; //!< Mutex to protect free_ports_
+  std::deque<int> free_ports_; //!< RTP ports of free pairs in order of reuse
+};
+
+/**
+ * @brief UDP sockets of one session bound to the pair from the pool and
+ * connected to the client
+ * @details Kernel doesn't look up route and destination for every datagram
+ * of connected socket, and ICMP errors of the client are reported on it.
+ * With RTCP multiplexing (RFC 5761) RTCP uses the RTP socket
+ */
+class UdpTransport {
+ public:
+  /**
+   * @brief Construct a new UdpTransport object
+   * @details Pairs, which can't be bound, are skipped
+   * @throws sock::BindError if there is no free pair, which can be bound
+   * @throws sock::SocketException if sockets can't be connected to the client
+   *
+   * @param pool Pool to take ports from
+   * @param client_ip Client ip address
+   * @param client_ports Client RTP and RTCP ports
+   * @param rtcp_mux If true, RTCP is sent and received through the RTP socket
+   */
+  UdpTransport(std::shared_ptr<PortPool> pool, const std::string &client_ip,
+               std::pair<int, int> client_ports, bool rtcp_mux);
+
+  UdpTransport(const UdpTransport &) = delete;
+  UdpTransport &operator=(const UdpTransport &) = delete;
+
+  /**
+   * @brief Close sockets and return ports to the pool
+   */
+  ~UdpTransport();
+
+  /**
+   * @brief Get local ports of the session
+   *
+   * @return RTP and RTCP ports. Both are RTP port with RTCP multiplexing
+   */
+  std::pair<int, int> GetServerPorts() const;
+
+  /**
+   * @brief Check if RTCP goes through the RTP socket
+   *
+   * @return true if RTCP is multiplexed with RTP
+   */
+  bool IsRtcpMuxed() const;
+
+  /**
+   * @brief Get socket connected to the client RTP port
+   *
+   * @return RTP socket
+   */
+  sock::ClientSocket &GetRtpSocket();
+
+  /**
+   * @brief Get socket connected to the client RTCP port
+   *
+   * @return RTCP socket or RTP socket with RTCP multiplexing
+   */
+  sock::ClientSocket &GetRtcpSocket();
+
+  /**
+   * @brief Get MTU of the path to the client
+   *
+   * @return MTU in bytes if it's known
+   */
+  std::optional<int> GetPathMtu() const;
+
+  /**
+   * @brief Remember that sockets got an error, e.g. ICMP port unreachable
+   * @details Thread-safe
+   *
+   * @return true if it's the first error of the session
+   */
+  bool MarkError();
+
+ private:
+  const std::shared_ptr<PortPool> pool_; //!< Pool the ports are taken from
+  int server_port_; //!< Local RTP port
+  std::optional<sock::ClientSocket> rtp_socket_; //!< Socket of RTP
+  //! Socket of RTCP. Empty with RTCP multiplexing
+  std::optional<sock::ClientSocket> rtcp_socket_;
+  std::atomic<bool> has_error_; //!< True, if sockets got an error
+};
+
+} // namespace pipeline
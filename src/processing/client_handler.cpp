@@ -0,0 +1,127 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "client_handler.h"
+
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+#include "rtsp/response_writer.h"
+#include "rtsp/interleaved.h"
+
+namespace processing {
+
+ClientHandler::ClientHandler(const RequestDispatcher &dispatcher) :
+dispatcher_(dispatcher),
+parser_(),
+request_view_(),
+pipelined_sessions_() {}
+
+void ClientHandler::operator()(sock::Connection &connection) {
+  std::string &input = connection.GetInput();
+  std::size_t consumed = 0;
+
+  while (!connection.IsClosing()) {
+    // Binary data can come between requests, when RTP goes over this connection
+    if (consumed < input.size() && input[consumed] == rtsp::kInterleavedMarker) {
+      rtsp::InterleavedData interleaved;
+      const std::size_t data_size = rtsp::ParseInterleavedData(
+          std::string_view(input).substr(consumed), interleaved);
+      if (data_size == 0) {
+        break;
+      }
+      consumed += data_size;
+      dispatcher_.DispatchInterleaved(interleaved.channel, interleaved.data);
+      continue;
+    }
+
+    rtsp::Response response;
+    bool close_connection = false;
+
+    try {
+      const std::size_t request_size = parser_.Parse(
+          std::string_view(input).substr(consumed), request_view_);
+      if (request_size == 0) {
+        break;
+      }
+      consumed += request_size;
+
+      rtsp::Request request = rtsp::ToRequest(request_view_);
+      request.client_ip = connection.GetPeerName();
+      request.connection_output = connection.GetSharedOutput();
+      close_connection = (request.method == rtsp::Method::kTeardown);
+      response = Handle(std::move(request));
+    } catch (const rtsp::ParseError &ex) {
+      // Request boundaries are lost, so nothing else can be read
+      std::cout << "Can't parse request: " << ex.what() << std::endl;
+      response = {400, "Bad Request"};
+      consumed = input.size();
+      close_connection = true;
+    }
+
+    std::cout << "\nResponse:\n" << response << std::endl;
+    rtsp::WriteResponseHead(response, connection.GetOutputBuffer());
+    connection.Attach(std::move(response.body));
+    if (close_connection) {
+      connection.Close();
+    }
+  }
+
+  input.erase(0, consumed);
+}
+
+rtsp::Response ClientHandler::Handle(rtsp::Request request) {
+  const std::string *pipeline_ptr = request.headers.Find(
+      rtsp::HeaderId::kPipelinedRequests);
+  if (pipeline_ptr == nullptr) {
+    std::cout << "\nRequest:\n" << request << std::endl;
+    return dispatcher_.Dispatch(std::move(request));
+  }
+
+  // Copy, because adding headers may invalidate the pointer
+  const std::string pipeline = *pipeline_ptr;
+  if (!request.headers.Contains(rtsp::HeaderId::kSession)) {
+    auto it = pipelined_sessions_.find(pipeline);
+    if (it != pipelined_sessions_.end()) {
+      request.headers[rtsp::HeaderId::kSession] = it->second;
+    }
+  }
+
+  std::cout << "\nRequest:\n" << request << std::endl;
+  const rtsp::Method method = request.method;
+  rtsp::Response response = dispatcher_.Dispatch(std::move(request));
+
+  if (method == rtsp::Method::kTeardown) {
+    pipelined_sessions_.erase(pipeline);
+  } else if (const std::string *session = response.headers.Find(
+                 rtsp::HeaderId::kSession)) {
+    pipelined_sessions_[pipeline] = *session;
+  }
+  response.headers[rtsp::HeaderId::kPipelinedRequests] = pipeline;
+
+  return response;
+}
+
+} // namespace processing
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "sock/connection.h"
+#include "rtsp/request.h"
+#include "rtsp/response.h"
+#include "rtsp/request_parser.h"
+#include "request_dispatcher.h"
+
+namespace processing {
+
+/**
+ * @brief Handler of the data received by one client connection
+ * @details Every complete request in the input is dispatched in order and
+ * responses are queued together, so pipelined requests are answered with one
+ * write. Supports Pipelined-Requests header, which lets client send requests
+ * depending on the session before session id is known. Binary data
+ * interleaved with requests is passed to the servlets
+ */
+class ClientHandler {
+ public:
+  /**
+   * @brief Construct a new ClientHandler object
+   *
+   * @param dispatcher Request dispatcher. Must outlive the handler
+   */
+  explicit ClientHandler(const RequestDispatcher &dispatcher);
+
+  /**
+   * @brief Dispatch all complete requests received by the connection
+   * @details Consumed requests are erased from the input, incomplete one is
+   * kept
+   *
+   * @param connection Connection with new data
+   */
+  void operator()(sock::Connection &connection);
+
+ private:
+  const RequestDispatcher &dispatcher_; //!< Request dispatcher
+  rtsp::RequestParser parser_; //!< Parser of the connection requests
+  rtsp::RequestView request_view_; //!< Last parsed request
+  //! Pipelined-Requests value -> Session value
+  std::unordered_map<std::string, std::string> pipelined_sessions_;
+
+  /**
+   * @brief Dispatch single request
+   *
+   * @param request Request to dispatch
+   * @return Response on the request
+   */
+  rtsp::Response Handle(rtsp::Request request);
+};
+
+} // namespace processing
@@ -0,0 +1,99 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "path_trie.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Cut the first segment off the path
+ *
+ * @param path Path like /a/b. Becomes /b
+ * @return First segment, i.e. a
+ */
+std::string_view PopSegment(std::string_view &path) {
+  while (!path.empty() && path.front() == '/') {
+    path.remove_prefix(1);
+  }
+
+  const std::size_t segment_end = std::min(path.find('/'), path.size());
+  const std::string_view segment = path.substr(0, segment_end);
+  path.remove_prefix(segment_end);
+
+  return segment;
+}
+
+} // namespace
+
+namespace processing {
+
+PathTrie::PathTrie() :
+root_() {}
+
+bool PathTrie::Insert(std::string_view path, std::shared_ptr<Servlet> servlet_ptr) {
+  Node *node = &root_;
+  for (std::string_view segment = PopSegment(path); !segment.empty();
+       segment = PopSegment(path)) {
+    auto it = node->children.find(segment);
+    if (it == node->children.end()) {
+      it = node->children.emplace(segment, std::make_unique<Node>()).first;
+    }
+    node = it->second.get();
+  }
+
+  if (node->servlet_ptr) {
+    return false;
+  }
+
+  node->servlet_ptr = std::move(servlet_ptr);
+  return true;
+}
+
+std::optional<std::pair<Servlet *, std::string_view>> PathTrie::Find(
+    std::string_view path) const {
+  std::optional<std::pair<Servlet *, std::string_view>> result;
+  if (root_.servlet_ptr) {
+    result.emplace(root_.servlet_ptr.get(), path);
+  }
+
+  const Node *node = &root_;
+  for (std::string_view segment = PopSegment(path); !segment.empty();
+       segment = PopSegment(path)) {
+    auto it = node->children.find(segment);
+    if (it == node->children.end()) {
+      break;
+    }
+
+    node = it->second.get();
+    if (node->servlet_ptr) {
+      result.emplace(node->servlet_ptr.get(), path);
+    }
+  }
+
+  return result;
+}
+
+} // namespace processing
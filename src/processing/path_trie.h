@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "servlet.h"
+
+namespace processing {
+
+/**
+ * @brief Trie of path segments for choosing servlet by url path
+ */
+class PathTrie {
+ public:
+  PathTrie();
+
+  /**
+   * @brief Register servlet on the path
+   *
+   * @param path Path like /a/b
+   * @param servlet_ptr Servlet
+   * @return true If servlet was registered
+   * @return false If path is already occupied
+   */
+  bool Insert(std::string_view path, std::shared_ptr<Servlet> servlet_ptr);
+
+  /**
+   * @brief Find servlet with the longest path, which is a prefix of the given
+   * path on segment boundary
+   *
+   * @param path Path like /a/b/c
+   * @return Servlet and the rest of the path after the servlet path
+   */
+  std::optional<std::pair<Servlet *, std::string_view>> Find(
+      std::string_view path) const;
+
+ private:
+  /**
+   * @brief Trie node, corresponding to one path segment
+   */
+  struct Node {
+    std::shared_ptr<Servlet> servlet_ptr; //!< Servlet on this path or nullptr
+    std::map<std::string, std::unique_ptr<Node>, std::less<>> children; //!< Segment -> Node
+  };
+
+  Node root_; //!< Node of the "/" path
+};
+
+} // namespace processing
@@ -25,98 +25,32 @@ SOFTWARE.
 #include "request_dispatcher.h"
 
 #include <utility>
-#include <regex>
-#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "rtsp/url.h"
 
 namespace {
 
 using ServletMethod = rtsp::Response (processing::Servlet::*)(const rtsp::Request &);
 
-const char kCSeq[] = "CSeq";
-
-/**
- * @brief Exception, that indicates that invalid url was received
- */
-class BadUrl : public std::runtime_error {
- public:
-  BadUrl(std::string_view message) :
-  std::runtime_error(message.data()) {}
+//! Servlet methods in order of rtsp::Method values. OPTIONS is served by
+//! the dispatcher itself
+const ServletMethod kServletMethods[] = {
+  &processing::Servlet::ServeDescribe,
+  &processing::Servlet::ServeAnnounce,
+  &processing::Servlet::ServeGetParameter,
+  nullptr,
+  &processing::Servlet::ServePause,
+  &processing::Servlet::ServePlay,
+  &processing::Servlet::ServeRecord,
+  &processing::Servlet::ServeSetup,
+  &processing::Servlet::ServeSetParameter,
+  &processing::Servlet::ServeTeardown
 };
 
-/**
- * @brief Extract path from url
- *
- * @param full_url A full url with protocol, hostname and etc.
- * @return Path from the url
- */
-std::string ExtractPath(const std::string &full_url) {
-  const uint kGroupsNumber = 7;
-  const std::string scheme = R"(^(\S+)://)";
-  const std::string login = R"(([^:\s]+)?)";
-  const std::string password = R"((\S+))";
-  const std::string login_password = R"((?:)" + login + R"((?::)" + password + R"()?@)?)";
-  const std::string hostname = R"(([^:/]+))";
-  const std::string port = R"((?::([0-9]+))?)";
-  const std::string path = R"(((?:/[^/\s]+)+))";
-  const std::regex reg_expr(scheme + login_password + hostname + port + path);
-  std::smatch matches;
-
-  if (!std::regex_search(full_url, matches, reg_expr) ||
-      (matches.size() < kGroupsNumber)) {
-    throw BadUrl("Bad url");
-  }
-
-  std::string path_value = matches[kGroupsNumber - 1].str();
-  if (*(path_value.rend()) == '/') {
-    path_value = path_value.substr(0, path_value.size() - 1);
-  }
-
-  return path_value;
-}
-
-/**
- * @brief Choose proper Servlet method to serve request according to the RTSP method
- *
- * @param rtsp_method Method from request
- * @return Pointer to the Servlet method
- */
-ServletMethod ChooseServletMethod(rtsp::Method rtsp_method) {
-  ServletMethod servlet_method = nullptr;
-
-  switch (rtsp_method) {
-    case rtsp::Method::kDescribe:
-      servlet_method = &processing::Servlet::ServeDescribe;
-      break;
-    case rtsp::Method::kAnnounce:
-      servlet_method = &processing::Servlet::ServeAnnounce;
-      break;
-    case rtsp::Method::kGetParameter:
-      servlet_method = &processing::Servlet::ServeGetParameter;
-      break;
-    case rtsp::Method::kPause:
-      servlet_method = &processing::Servlet::ServePause;
-      break;
-    case rtsp::Method::kPlay:
-      servlet_method = &processing::Servlet::ServePlay;
-      break;
-    case rtsp::Method::kRecord:
-      servlet_method = &processing::Servlet::ServeRecord;
-      break;
-    case rtsp::Method::kSetup:
-      servlet_method = &processing::Servlet::ServeSetup;
-      break;
-    case rtsp::Method::kSetParameter:
-      servlet_method = &processing::Servlet::ServeSetParameter;
-      break;
-    case rtsp::Method::kTeardown:
-      servlet_method = &processing::Servlet::ServeTeardown;
-      break;
-    default:
-      throw std::out_of_range("Unknown method");
-  }
-
-  return servlet_method;
-}
+static_assert(std::size(kServletMethods) ==
+              static_cast<std::size_t>(rtsp::Method::kTeardown) + 1);
 
 /**
  * @brief Put all methods in string spacing with coma
@@ -145,32 +79,31 @@ std::string MethodsToString(const std::unordered_set<rtsp::Method> &methods) {
 namespace processing {
 
 RequestDispatcher::RequestDispatcher() :
-url_to_servlet_(),
+servlets_(),
+servlet_list_(),
 acceptable_methods_({rtsp::Method::kOptions}),
-acceptable_urls_() {}
+public_header_(MethodsToString(acceptable_methods_)) {}
 
 RequestDispatcher &RequestDispatcher::RegisterServlet(
     const std::string &url, std::shared_ptr<Servlet> servlet_ptr) {
-  auto res = url_to_servlet_.insert({std::move(url), servlet_ptr});
-  if (res.second) {
-    acceptable_urls_.insert(res.first->first);
-    acceptable_methods_.merge(servlet_ptr->GetAcceptableMethods());
+  std::unordered_set<rtsp::Method> methods = servlet_ptr->GetAcceptableMethods();
+  if (servlets_.Insert(url, servlet_ptr)) {
+    servlet_list_.push_back(std::move(servlet_ptr));
+    acceptable_methods_.merge(methods);
+    public_header_ = MethodsToString(acceptable_methods_);
   }
 
   return *this;
 }
 
 rtsp::Response RequestDispatcher::Dispatch(rtsp::Request request) const {
-  if (!request.headers.count(kCSeq)) {
+  const std::string *cseq = request.headers.Find(rtsp::HeaderId::kCSeq);
+  if (cseq == nullptr) {
     return {400, "Bad Request"};
   }
 
-  rtsp::Response response = {
-      0, "",
-      {
-          {kCSeq, request.headers.at(kCSeq)}
-      }
-  };
+  rtsp::Response response;
+  response.headers[rtsp::HeaderId::kCSeq] = *cseq;
 
   if (request.version != 1.0) {
     response.code = 505;
@@ -183,65 +116,70 @@ rtsp::Response RequestDispatcher::Dispatch(rtsp::Request request) const {
     return response;
   }
 
-  try {
-    rtsp::Response::Headers old_response_headers = response.headers;
+  rtsp::Headers old_response_headers = response.headers;
+  if (request.method == rtsp::Method::kOptions) {
+    // OPTIONS with Session header is a keep-alive. Its url may be "*"
+    if (request.headers.Contains(rtsp::HeaderId::kSession)) {
+      for (const std::shared_ptr<Servlet> &servlet : servlet_list_) {
+        servlet->KeepAlive(request);
+      }
+    }
+    response = GetOptions();
+  } else {
+    const std::optional<rtsp::Url> url = rtsp::SplitUrl(request.url);
+    if (!url.has_value()) {
+      response.code = 400;
+      response.description = "Bad Request";
+      return response;
+    }
 
-    if (request.method == rtsp::Method::kOptions) {
-      response = GetOptions();
-    } else {
-      ServletMethod method = ChooseServletMethod(request.method);
-      auto [path, servlet_ptr] = *ChooseServlet(request.url);
-      request.url = ExtractPath(request.url).substr(path.size());
-      response = (servlet_ptr.get()->*method)(request);
+    const auto servlet = servlets_.Find(url->path);
+    if (!servlet.has_value()) {
+      response.code = 404;
+      response.description = "Not Found";
+      return response;
     }
 
-    response.headers.merge(std::move(old_response_headers));
-  }
-  catch (const BadUrl &ex) {
-    response.code = 400;
-    response.description = "Bad Request";
-  }
-  catch (const std::out_of_range &ex) {
-    response.code = 404;
-    response.description = "Not Found";
-  }
-  catch (const std::runtime_error &ex) {
-    response.code = 500;
-    response.description = "Internal Server Error";
+    const ServletMethod method = kServletMethods[static_cast<std::size_t>(
+        request.method)];
+    auto [servlet_ptr, rest_path] = servlet.value();
+    request.url = std::string(rest_path);
+    try {
+      servlet_ptr->KeepAlive(request);
+      response = (servlet_ptr->*method)(request);
+    } catch (const std::exception &) {
+      response.code = 500;
+      response.description = "Internal Server Error";
+      return response;
+    }
   }
 
+  // Keep CSeq first
+  old_response_headers.Merge(response.headers);
+  response.headers = std::move(old_response_headers);
+
   return response;
 }
 
+void RequestDispatcher::OnTimer(const std::chrono::steady_clock::time_point now) const {
+  for (const std::shared_ptr<Servlet> &servlet : servlet_list_) {
+    servlet->OnTimer(now);
+  }
+}
+
+void RequestDispatcher::DispatchInterleaved(const uint8_t channel,
+                                            Span<const Byte> data) const {
+  for (const std::shared_ptr<Servlet> &servlet : servlet_list_) {
+    servlet->OnInterleavedData(channel, data);
+  }
+}
+
 rtsp::Response RequestDispatcher::GetOptions() const {
   return {200, "OK",
       {
-          {"Public", MethodsToString(acceptable_methods_)}
+          {"Public", public_header_}
       }
   };
 }
 
-RequestDispatcher::UrlToServletMap::const_iterator RequestDispatcher::ChooseServlet(
-    const std::string &url) const {
-  if (url_to_servlet_.size() == 0) {
-    throw std::out_of_range("There aren't any servlets at all");
-  }
-
-  const std::string path = ExtractPath(url);
-  auto it = url_to_servlet_.lower_bound(path);
-  if ((it != url_to_servlet_.end()) &&
-      (it->first == path)) {
-    return it;
-  }
-
-  if (it != url_to_servlet_.begin()) {
-    --it;
-    if (path.find(it->first) == 0) {
-      return it;
-    }
-  }
-
-  throw std::out_of_range("Can't find suitable servlet");
-}
-
 } // namespace processing
@@ -24,13 +24,16 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+
 #include <string>
-#include <string_view>
-#include <map>
 #include <unordered_set>
 #include <memory>
+#include <vector>
+#include <chrono>
 
 #include "servlet.h"
+#include "path_trie.h"
 
 namespace processing {
 
@@ -62,13 +65,26 @@ class RequestDispatcher {
    */
   rtsp::Response Dispatch(rtsp::Request request) const;
 
- private:
-  using UrlToServletMap = std::map<std::string, std::shared_ptr<Servlet>>;
+  /**
+   * @brief Let all servlets do their periodic work
+   *
+   * @param now Current time
+   */
+  void OnTimer(std::chrono::steady_clock::time_point now) const;
+
+  /**
+   * @brief Pass binary data interleaved with requests to all servlets
+   *
+   * @param channel Channel number
+   * @param data Received data
+   */
+  void DispatchInterleaved(uint8_t channel, Span<const Byte> data) const;
 
-  //! Url -> Servlet inheritor
-  UrlToServletMap url_to_servlet_;
+ private:
+  PathTrie servlets_; //!< Path -> Servlet inheritor
+  std::vector<std::shared_ptr<Servlet>> servlet_list_; //!< All registered servlets
   std::unordered_set<rtsp::Method> acceptable_methods_; //!< All acceptable methods
-  std::unordered_set<std::string_view> acceptable_urls_; //!< All acceptable urls
+  std::string public_header_; //!< Value of Public header for OPTIONS response
 
   /**
    * @brief Get response on OPTIONS request
@@ -76,14 +92,6 @@ class RequestDispatcher {
    * @return Response with acceptable methods
    */
   rtsp::Response GetOptions() const;
-
-  /**
-   * @brief Choose proper Servlet to serve request on the given url
-   *
-   * @param url Request url
-   * @return Iterator, pointing on {Servlet url, Servlet} pair
-   */
-  UrlToServletMap::const_iterator ChooseServlet(const std::string &url) const;
 };
 
 } // namespace processing
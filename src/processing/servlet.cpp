@@ -74,6 +74,12 @@ rtsp::Response Servlet::ServeTeardown(const rtsp::Request &) {
   return kMethodNotAllowed;
 }
 
+void Servlet::KeepAlive(const rtsp::Request &) {}
+
+void Servlet::OnTimer(std::chrono::steady_clock::time_point) {}
+
+void Servlet::OnInterleavedData(uint8_t, Span<const Byte>) {}
+
 void Servlet::AddMethod(rtsp::Method method) {
   acceptable_methods_.insert(method);
 }
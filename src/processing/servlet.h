@@ -24,7 +24,13 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+
 #include <unordered_set>
+#include <chrono>
+
+#include "byte.h"
+#include "span.h"
 
 #include "rtsp/request.h"
 #include "rtsp/response.h"
@@ -108,6 +114,32 @@ class Servlet {
    */
   virtual rtsp::Response ServeTeardown(const rtsp::Request &request);
 
+  /**
+   * @brief Refresh session of the request, if the servlet has it
+   * @details Called before serving every request routed to the servlet and
+   * for OPTIONS requests with Session header. Does nothing by default
+   *
+   * @param request Request from the client
+   */
+  virtual void KeepAlive(const rtsp::Request &request);
+
+  /**
+   * @brief Do periodic work, e.g. expire sessions
+   * @details Called from the thread serving requests. Does nothing by default
+   *
+   * @param now Current time
+   */
+  virtual void OnTimer(std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief Handle binary data interleaved with requests, e.g. RTCP reports
+   * @details Called from the thread serving requests. Does nothing by default
+   *
+   * @param channel Channel number
+   * @param data Received data
+   */
+  virtual void OnInterleavedData(uint8_t channel, Span<const Byte> data);
+
  protected:
   /**
    * @brief Add RTSP method to acceptable ones
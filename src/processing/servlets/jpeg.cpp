@@ -25,212 +25,518 @@ SOFTWARE.
 #include "jpeg.h"
 
 #include <unistd.h>
+#include <strings.h>
 
 #include <iostream>
 #include <chrono>
-#include <random>
-#include <chrono>
-#include <jpeglib.h>
+#include <iomanip>
+#include <sstream>
+#include <optional>
+#include <algorithm>
+#include <charconv>
+#include <vector>
 
 #include "sdp/session_description.h"
-#include "camera.h"
-#include "sock/exception.h"
-#include "sock/client_socket.h"
-#include "byte.h"
+#include "pipeline/pipeline.h"
 #include "rtp/mjpeg/packet.h"
-#include "rtp/packet.h"
-#include "profiler.h"
+#include "sock/exception.h"
+#include "rtcp/packet.h"
+#include "pipeline/rtp_sink.h"
 
 namespace {
 
 using namespace std::literals::string_literals;
 
+using MulticastConfig = processing::servlets::Jpeg::MulticastConfig;
+
+//! Options of datagrams sent without multicast
+const sock::MulticastOptions kDefaultMulticastOptions = {
+    "", // interface_ip. Default route
+    1 // ttl
+};
+
 /**
  * @brief Build SDP video media description with jpeg-encoding
  *
- * @param ip_address IP address of this machine
+ * @param connection_address Address of the connection: IP address of this
+ * machine or multicast group with TTL
+ * @param port Media port or 0 if it's chosen with SETUP
+ * @param feedback If true, RTP/AVPF profile with generic NACK (RFC 4585) is
+ * offered, so clients set up retransmission of lost packets
  * @param track_name Name of the video tack
+ * @param frame_source Source of the streamed frames
  * @return Video media description
  */
-sdp::MediaDescription BuildMediaDescription(const std::string &ip_address,
-                                            const std::string &track_name) {
+sdp::MediaDescription BuildMediaDescription(const std::string &connection_address,
+                                            const int port,
+                                            const bool feedback,
+                                            const std::string &track_name,
+                                            const video::FrameSource &frame_source) {
   const int kMediaFormatCode = 26; // Jpeg code
 
   sdp::MediaDescription media_descr;
 
-  media_descr.name = "video 0 RTP/AVP "s + std::to_string(kMediaFormatCode);
-  media_descr.connection = "IN IP4 "s + ip_address;
+  media_descr.name = "video "s + std::to_string(port) +
+      (feedback ? " RTP/AVPF " : " RTP/AVP ") + std::to_string(kMediaFormatCode);
+  media_descr.connection = "IN IP4 "s + connection_address;
 
   media_descr.attributes.emplace_back("control", track_name);
+  if (feedback) {
+    media_descr.attributes.emplace_back(
+        "rtcp-fb", std::to_string(kMediaFormatCode) + " nack");
+  }
 
-  const uint height = Camera::GetInstance().getHeight();
-  const uint width = Camera::GetInstance().getWidth();
+  const uint height = frame_source.GetHeight();
+  const uint width = frame_source.GetWidth();
   media_descr.attributes.emplace_back(
       "cliprect",
       "0,0,"s + std::to_string(height) + "," + std::to_string(width));
 
   media_descr.attributes.emplace_back(
       "framerate",
-      std::to_string(Camera::GetInstance().getFrameRate()));
+      std::to_string(frame_source.GetFrameRate()));
 
   return media_descr;
 }
 
 /**
  * @brief Build SDP session description, i.e. body of DESCRIBE rtsp response
+ * @details Multicast group is advertised, if multicast is enabled. Otherwise
+ * RTP/AVPF with generic NACK is advertised, which multicast doesn't support.
+ * RTP/AVP is still accepted in SETUP
  *
  * @param track_name Name of the video tack
+ * @param frame_source Source of the streamed frames
+ * @param multicast Multicast stream configuration, if multicast is enabled
  * @return Session description
  */
-sdp::SessionDescription BuildSessionDescription(const std::string &track_name) {
+sdp::SessionDescription BuildSessionDescription(
+    const std::string &track_name, const video::FrameSource &frame_source,
+    const std::optional<MulticastConfig> &multicast) {
   const auto now = std::chrono::system_clock::now();
   const uint64_t kSessionId = std::chrono::duration_cast<std::chrono::seconds>(
       now.time_since_epoch()).count();
   const int kSessionVersion = 1;
   const std::string kIp = "0.0.0.0";
 
+  // getlogin() fails without controlling terminal. SDP uses "-" for unknown user
+  const char *login = getlogin();
+  const std::string username = (login != nullptr ? login : "-");
+
   sdp::SessionDescription descr;
   descr.version = 0;
-  descr.originator_and_session_id = std::string(getlogin()) + " " +
+  descr.originator_and_session_id = username + " " +
       std::to_string(kSessionId) + " " + std::to_string(kSessionVersion) +
       " IN IP4 " + kIp;
   descr.session_name = "Session streamed by Pi RTSP Server";
   descr.info = "jpeg";
   descr.time_descriptions.push_back(sdp::TimeDescription{{0, 0}, std::nullopt});
 
-  sdp::MediaDescription media_descr = BuildMediaDescription(kIp, track_name);
+  sdp::MediaDescription media_descr = BuildMediaDescription(
+      (multicast ? multicast->group + "/" + std::to_string(multicast->options.ttl) :
+                   kIp),
+      (multicast ? multicast->port : 0), !multicast, track_name, frame_source);
   descr.media_descriptions.push_back(std::move(media_descr));
 
   return descr;
 }
 
 /**
- * @brief Extract client RTP and RTCP ports
+ * @brief Transport of the RTP stream chosen by the client
+ */
+struct Transport {
+  /**
+   * @brief Ways to deliver RTP
+   */
+  enum class Type {
+    kUnicast, //!< UDP to the client ports
+    kMulticast, //!< UDP to the multicast group shared by clients
+    kInterleaved //!< Over RTSP connection
+  };
+
+  Type type; //!< Way to deliver RTP
+  //! Client RTP and RTCP ports or interleaved channels. Unused for multicast.
+  //! Both are RTP port with RTCP multiplexing
+  std::pair<int, int> ports;
+  bool rtcp_mux; //!< True, if RTCP is multiplexed with RTP (RFC 5761)
+  //! True, if client chose RTP/AVPF profile, so lost packets are
+  //! retransmitted on its generic NACKs (RFC 4585)
+  bool feedback;
+};
+
+/**
+ * @brief Check if transport has parameter without value, e.g. multicast
+ * @details Names are compared case-insensitively, as clients spell RTCP-mux
+ * differently
  *
- * @param transport Value of Transport header
- * @return pair of RTP and RTCP ports in success
- * @return {0, 0} in other way
+ * @param transport_spec One transport specification of Transport header
+ * @param name Parameter name
+ * @return true if parameter is present
  */
-std::pair<int, int> ExtractClientPorts(const std::string &transport) {
-  const std::string kClientPortStr = "client_port=";
-  std::istringstream iss(transport);
+bool HasParameter(const std::string &transport_spec, const std::string &name) {
+  std::istringstream iss(transport_spec);
+  std::string param;
+
+  while (std::getline(iss, param, ';')) {
+    if (strcasecmp(param.c_str(), name.c_str()) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Extract range parameter of the transport, e.g. client_port=a-b
+ * @details If the second number is absent, it's the first one plus one
+ *
+ * @param transport_spec One transport specification of Transport header
+ * @param name Parameter name
+ * @return pair of numbers if parameter was found
+ */
+std::optional<std::pair<int, int>> ExtractRange(const std::string &transport_spec,
+                                                const std::string &name) {
+  const std::string prefix = name + "=";
+  std::istringstream iss(transport_spec);
   std::string param;
 
   while (std::getline(iss, param, ';')) {
-    uint pos = param.find(kClientPortStr);
+    std::size_t pos = param.find(prefix);
     if (pos != std::string::npos) {
-      std::istringstream ports_iss(param.substr(pos + kClientPortStr.size()));
-      std::pair<int, int> ports;
-      ports_iss >> ports.first;
-      ports_iss.ignore(1);
-      ports_iss >> ports.second;
+      std::istringstream range_iss(param.substr(pos + prefix.size()));
+      std::pair<int, int> range;
+      if (!(range_iss >> range.first)) {
+        return std::nullopt;
+      }
+      range_iss.ignore(1);
+      if (!(range_iss >> range.second)) {
+        range.second = range.first + 1;
+      }
+
+      return range;
+    }
+  }
+
+  return std::nullopt;
+}
+
+/**
+ * @brief Choose the first supported transport offered by the client
+ * @details Supports RTP/AVP over UDP with client_port, RTP/AVP multicast, if
+ * it's enabled, and RTP/AVP/TCP with interleaved channels. Interleaved
+ * channels default to 0-1. Multicast destination is always chosen by server.
+ * UDP unicast may ask for RTCP multiplexing with RTCP-mux parameter and for
+ * retransmission on NACK with RTP/AVPF profile
+ *
+ * @param transport Value of Transport header
+ * @param multicast_enabled If true, multicast can be chosen
+ * @return Transport if any is supported
+ */
+std::optional<Transport> ChooseTransport(const std::string &transport,
+                                         const bool multicast_enabled) {
+  const std::string kUdpProfile = "RTP/AVP";
+  const std::string kTcpProfile = "RTP/AVP/TCP";
+  const std::string kFeedbackProfile = "RTP/AVPF";
+  std::istringstream iss(transport);
+  std::string spec;
+
+  while (std::getline(iss, spec, ',')) {
+    spec.erase(0, spec.find_first_not_of(' '));
+    const std::string profile = spec.substr(0, spec.find(';'));
+
+    if (profile == kTcpProfile) {
+      const std::pair<int, int> channels = ExtractRange(spec, "interleaved")
+          .value_or(std::pair<int, int>(0, 1));
+      const auto is_channel = [](int channel) {
+        return channel >= 0 && channel <= UINT8_MAX;
+      };
+      if (is_channel(channels.first) && is_channel(channels.second) &&
+          channels.first != channels.second) {
+        return Transport{Transport::Type::kInterleaved, channels, false, false};
+      }
+    } else if (profile == kUdpProfile || profile == kUdpProfile + "/UDP" ||
+               profile == kFeedbackProfile || profile == kFeedbackProfile + "/UDP") {
+      const bool feedback = (profile == kFeedbackProfile ||
+                             profile == kFeedbackProfile + "/UDP");
+      // NACKs of multicast clients are not collected
+      if (HasParameter(spec, "multicast")) {
+        if (multicast_enabled && !feedback) {
+          return Transport{Transport::Type::kMulticast, {0, 0}, false, false};
+        }
+        continue;
+      }
 
-      return ports;
+      const std::optional<std::pair<int, int>> ports = ExtractRange(spec,
+                                                                    "client_port");
+      if (ports && ports->first > 0) {
+        if (HasParameter(spec, "RTCP-mux")) {
+          return Transport{Transport::Type::kUnicast, {ports->first, ports->first},
+                           true, feedback};
+        }
+        return Transport{Transport::Type::kUnicast, *ports, false, feedback};
+      }
     }
   }
 
-  return {0, 0};
+  return std::nullopt;
 }
 
 /**
- * @brief Convert raw image data to jpeg data
+ * @brief Choose number of JPEG bytes in one RTP packet of the client
+ * @details Starts from the server default and lowers it to fit requested
+ * blocksize and MTU of the path to the client
  *
- * @param raw_image Pointer to raw image data
- * @param width Image width
- * @param height Image height
- * @param quality Quality of resulting image in [0, 100] range
- * @return Jpeg image in bytes
+ * @param path_mtu MTU of the path to the client, if it's known. Unknown
+ * e.g. for interleaved streams
+ * @param blocksize Value of Blocksize header, if client sent it
+ * @return Number of bytes in success
+ * @return std::nullopt if blocksize is invalid or leaves less than
+ * kMinBytesPerPacket bytes of JPEG data, so it can't be honored
  */
-Bytes ConvertToJpeg(JSAMPLE *raw_image, const int width, const int height,
-                         const int quality) {
-  jpeg_compress_struct cinfo;
-  jpeg_error_mgr jerr;
-  unsigned char *buffer = nullptr;
-  unsigned long buffer_size = 0;
+std::optional<std::size_t> ChooseBytesPerPacket(const std::optional<int> path_mtu,
+                                                const std::string *blocksize) {
+  using namespace rtp::mjpeg;
+
+  std::size_t bytes_per_packet = kDefaultBytesPerPacket;
+
+  if (blocksize != nullptr) {
+    std::size_t requested = 0;
+    const char *end = blocksize->data() + blocksize->size();
+    const auto [ptr, ec] = std::from_chars(blocksize->data(), end, requested);
+    if (ec != std::errc() || ptr != end) {
+      return std::nullopt;
+    }
+
+    // Blocksize excludes RTP header, but includes JPEG header
+    const std::size_t requested_bytes = requested - std::min(requested, kJpegHeaderSize);
+    if (requested_bytes < kMinBytesPerPacket) {
+      return std::nullopt;
+    }
+    bytes_per_packet = std::min(bytes_per_packet, requested_bytes);
+  }
 
-  JSAMPROW row_pointer[1];	// pointer to JSAMPLE row[s]
-  int row_stride;		    // physical row width in image buffer
+  if (path_mtu) {
+    const std::size_t kIpAndUdpHeadersSize = 20 + 8;
+    const std::size_t headers_size = kIpAndUdpHeadersSize + kHeadersSize;
+    const auto mtu = static_cast<std::size_t>(*path_mtu);
+    bytes_per_packet = std::min(bytes_per_packet, mtu - std::min(mtu, headers_size));
+  }
 
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_compress(&cinfo);
+  return std::clamp(bytes_per_packet, kMinBytesPerPacket, kMaxBytesPerPacket);
+}
 
-  jpeg_mem_dest(&cinfo, &buffer, &buffer_size);
+//! Max number of frames of one session waiting in its transport queue.
+//! Frames above are dropped, so slow clients don't accumulate latency
+const std::size_t kMaxQueuedFrames = 3;
 
-  cinfo.image_width = width;
-  cinfo.image_height = height;
-  cinfo.input_components = 3;		// # of color components per pixel
-  cinfo.in_color_space = JCS_RGB; 	// colorspace of input image
+//! Number of the last frames, which packets of one unicast UDP session are
+//! kept for retransmission. All sessions keep the same frames
+const std::size_t kRetransmissionHistoryFrames = 3;
+//! Max number of packets retransmitted before one frame
+const std::size_t kMaxRetransmitsPerFrame = 32;
 
-  jpeg_set_defaults(&cinfo);
-  jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+//! Configuration of the capture -> encode -> send pipeline
+const pipeline::Pipeline::Config kPipelineConfig = {
+    2, // queue_capacity
+    true, // drop_stale_frames
+    70, // quality
+    kMaxQueuedFrames + kRetransmissionHistoryFrames // retained_frames
+};
 
-  jpeg_start_compress(&cinfo, TRUE);
+//! Local port RTP of multicast is sent from. RTCP uses the next one
+const int kServerRtpPort = 6970;
 
-  row_stride = width * 3;	// JSAMPLEs per row in image_buffer
+//! The first local RTP port of unicast sessions. Every session takes a pair
+const int kFirstSessionPort = 6972;
+//! Number of port pairs of unicast sessions, which limits number of sessions
+const std::size_t kSessionPortPairs = 256;
 
-  while (cinfo.next_scanline < cinfo.image_height) {
-    row_pointer[0] = & raw_image[cinfo.next_scanline * row_stride];
-    (void) jpeg_write_scanlines(&cinfo, row_pointer, 1);
-  }
+//! Time of client inactivity, after which its session is closed
+const std::chrono::seconds kSessionTimeout(60);
+//! Precision of session timeouts
+const std::chrono::seconds kSessionTimerTick(1);
+
+//! Default part of the frame interval to spread packets of the frame over
+const double kDefaultPacingFraction = 0.5;
+
+/**
+ * @brief Build parameters of the RTP stream of the source
+ *
+ * @param bytes_per_packet Number of JPEG bytes in one packet
+ * @param frame_source Source of the streamed frames
+ * @param retransmission If true, lost packets are retransmitted on NACK.
+ * Only unicast UDP with RTP/AVPF profile gets it
+ * @return Stream parameters
+ */
+pipeline::StreamConfig BuildStreamConfig(const std::size_t bytes_per_packet,
+                                         const video::FrameSource &frame_source,
+                                         const bool retransmission) {
+  return {
+      bytes_per_packet,
+      std::chrono::nanoseconds(std::chrono::seconds(1)) /
+          std::max(frame_source.GetFrameRate(), 1u),
+      kDefaultPacingFraction,
+      kMaxQueuedFrames,
+      (retransmission ? kRetransmissionHistoryFrames : 0),
+      kMaxRetransmitsPerFrame
+  };
+}
 
-  jpeg_finish_compress(&cinfo);
-  jpeg_destroy_compress(&cinfo);
+/**
+ * @brief Split text/parameters body into non-empty lines
+ *
+ * @param body Request body
+ * @return Lines without line breaks
+ */
+std::vector<std::string> SplitParameterLines(const std::string &body) {
+  std::vector<std::string> lines;
+  std::istringstream iss(body);
+  std::string line;
+  while (std::getline(iss, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      lines.push_back(std::move(line));
+    }
+  }
 
-  Bytes res(buffer, buffer + buffer_size);
-  free(buffer);
-  return res;
+  return lines;
 }
 
 /**
- * @brief Grab image from camera in jpeg format
+ * @brief Get value of the stream parameter
  *
- * @param quality Quality of resulting image in [0, 100] range
- * @return Jpeg image in bytes
+ * @param streamer Stream of the session
+ * @param name Parameter name
+ * @return Value if parameter is known
  */
-Bytes GrabImage(const int quality) {
-  raspicam::RaspiCam &camera = Camera::GetInstance();
+std::optional<std::string> GetStreamParameter(const pipeline::RtpStreamer &streamer,
+                                              const std::string &name) {
+  if (name == "packet_count") {
+    return std::to_string(streamer.GetPacketCount());
+  }
+  if (name == "octet_count") {
+    return std::to_string(streamer.GetOctetCount());
+  }
+  if (name == "bytes_per_packet") {
+    return std::to_string(streamer.GetBytesPerPacket());
+  }
+  if (name == "pacing_fraction") {
+    return std::to_string(streamer.GetPacingFraction());
+  }
+  if (name == "dropped_frames") {
+    return std::to_string(streamer.GetDroppedFrames());
+  }
+  if (name == "retransmitted_packets") {
+    return std::to_string(streamer.GetRetransmittedPackets());
+  }
+
+  // Statistics reported by the client
+  if (name != "fraction_lost" && name != "cumulative_lost" &&
+      name != "jitter_ms" && name != "round_trip_time_ms") {
+    return std::nullopt;
+  }
+
+  const std::optional<rtcp::ReceptionStats> stats = streamer.GetReceptionStats();
+  if (!stats) {
+    return "unknown";
+  }
+  if (name == "fraction_lost") {
+    return std::to_string(stats->fraction_lost);
+  }
+  if (name == "cumulative_lost") {
+    return std::to_string(stats->cumulative_lost);
+  }
+  if (name == "jitter_ms") {
+    return std::to_string(stats->jitter_ms);
+  }
+  return (stats->round_trip_time_ms ? std::to_string(*stats->round_trip_time_ms) :
+                                      "unknown");
+}
 
-  camera.grab();
-  auto raw_image_ptr = std::make_unique<unsigned char[]>(
-      camera.getImageTypeSize(raspicam::RASPICAM_FORMAT_RGB));
-  camera.retrieve(raw_image_ptr.get());
+/**
+ * @brief Get value of the pipeline parameter
+ * @details Pipeline is shared by all sessions, so values are the same for them
+ *
+ * @param stats Statistics of the pipeline, if it's running
+ * @param name Parameter name
+ * @return Value if parameter is known
+ */
+std::optional<std::string> GetPipelineParameter(const std::optional<pipeline::Stats> &stats,
+                                                const std::string &name) {
+  if (name != "capture_queue_depth" && name != "encode_queue_depth" &&
+      name != "send_queue_depth" && name != "encode_dropped_frames" &&
+      name != "send_dropped_frames") {
+    return std::nullopt;
+  }
 
-  return ConvertToJpeg(raw_image_ptr.get(), camera.getWidth(),
-                       camera.getHeight(), quality);
+  if (!stats) {
+    return "unknown";
+  }
+  if (name == "capture_queue_depth") {
+    return std::to_string(stats->capture_queue_depth);
+  }
+  if (name == "encode_queue_depth") {
+    return std::to_string(stats->encode_queue_depth);
+  }
+  if (name == "send_queue_depth") {
+    return std::to_string(stats->send_queue_depth);
+  }
+  if (name == "encode_dropped_frames") {
+    return std::to_string(stats->encode_dropped_frames);
+  }
+  return std::to_string(stats->send_dropped_frames);
 }
 
 } // namespace
 
 namespace processing::servlets {
 
-Jpeg::Jpeg() :
-client_connected_(false),
-teardown_(false),
-session_id_(0),
-client_ports_(0, 0),
-play_queue_(),
-play_worker_(&Jpeg::PlayWorkerThread, this),
-play_worker_stop_(false),
-play_worker_mutex_(),
-play_worker_notifier_() {
+Jpeg::Jpeg(std::shared_ptr<video::FrameSource> frame_source, bool kernel_pacing,
+           std::optional<MulticastConfig> multicast) :
+frame_source_(std::move(frame_source)),
+multicast_(std::move(multicast)),
+publisher_(frame_source_, kPipelineConfig),
+packetizer_(std::make_shared<pipeline::FramePacketizer>()),
+port_pool_(std::make_shared<pipeline::PortPool>(kFirstSessionPort, kSessionPortPairs)),
+egress_(std::make_shared<pipeline::RtpEgress>(pipeline::RtpEgress::Config{
+    kernel_pacing, // kernel_pacing
+    kServerRtpPort, // port
+    (multicast_ ? multicast_->options : kDefaultMulticastOptions) // multicast
+})),
+rtcp_(kServerRtpPort + 1,
+      (multicast_ ? multicast_->options : kDefaultMulticastOptions)),
+multicast_streamer_(),
+multicast_viewers_(0),
+sessions_(),
+session_timers_(kSessionTimerTick, std::chrono::steady_clock::now()),
+expired_sessions_() {
   AddMethod(rtsp::Method::kDescribe);
   AddMethod(rtsp::Method::kSetup);
   AddMethod(rtsp::Method::kPlay);
+  AddMethod(rtsp::Method::kGetParameter);
+  AddMethod(rtsp::Method::kSetParameter);
   AddMethod(rtsp::Method::kTeardown);
+
+  if (multicast_) {
+    multicast_streamer_ = std::make_shared<pipeline::RtpStreamer>(
+        BuildStreamConfig(rtp::mjpeg::kDefaultBytesPerPacket, *frame_source_, false),
+        packetizer_,
+        std::make_unique<pipeline::UdpSink>(multicast_->group, multicast_->port,
+                                            egress_));
+  }
 }
 
 Jpeg::~Jpeg() {
-  {
-    std::lock_guard guard(play_worker_mutex_);
-    play_worker_stop_ = true;
+  for (const std::shared_ptr<Session> &session : sessions_.Clear()) {
+    CloseSession(*session);
   }
-  play_worker_notifier_.notify_one();
-  play_worker_.join();
 }
 
 rtsp::Response Jpeg::ServeDescribe(const rtsp::Request &) {
   std::ostringstream oss;
-  oss << BuildSessionDescription(kVideoTrackName);
+  oss << BuildSessionDescription(kVideoTrackName, *frame_source_, multicast_);
   std::string descr_str = oss.str();
 
   return {200, "OK",
@@ -245,49 +551,138 @@ rtsp::Response Jpeg::ServeDescribe(const rtsp::Request &) {
 rtsp::Response Jpeg::ServeSetup(const rtsp::Request &request) {
   using namespace std::string_literals;
 
-  const char kSessionHeader[] = "Session";
-  const char kTransportHeader[] = "Transport";
   rtsp::Response response;
 
   if (request.url != "/"s + kVideoTrackName) {
     return {404, "Not Found"};
   }
 
-  if (request.headers.count(kSessionHeader) &&
-      std::stoul(request.headers.at(kSessionHeader)) == session_id_) {
+  if (FindSession(request)) {
     return {459, "Aggregate Operation Not Allowed"};
   }
 
-  if (client_connected_) {
-    return {423, "Locked"};
+  const std::string *transport = request.headers.Find(rtsp::HeaderId::kTransport);
+  if (transport == nullptr) {
+    return {461, "Unsupported Transport"};
+  }
+
+  const std::optional<Transport> chosen_transport = ChooseTransport(
+      *transport, multicast_.has_value());
+  if (!chosen_transport || (chosen_transport->type == Transport::Type::kInterleaved &&
+                            !request.connection_output)) {
+    return {461, "Unsupported Transport"};
   }
+  const std::pair<int, int> &ports = chosen_transport->ports;
+
+  std::shared_ptr<pipeline::RtpStreamer> streamer;
+  std::shared_ptr<pipeline::UdpTransport> udp_transport;
+  const std::string *blocksize = request.headers.Find(rtsp::HeaderId::kBlocksize);
+  if (chosen_transport->type == Transport::Type::kMulticast) {
+    // Stream is shared, so it can't follow blocksize of the client
+    streamer = multicast_streamer_;
+  } else {
+    const bool interleaved = (chosen_transport->type == Transport::Type::kInterleaved);
+    if (!interleaved) {
+      try {
+        udp_transport = std::make_shared<pipeline::UdpTransport>(
+            port_pool_, request.client_ip, ports, chosen_transport->rtcp_mux);
+      } catch (const sock::BindError &ex) {
+        std::cout << "Can't set up session: " << ex.what() << std::endl;
+        return {503, "Service Unavailable"};
+      }
+    }
+
+    const std::optional<std::size_t> bytes_per_packet = ChooseBytesPerPacket(
+        (udp_transport ? udp_transport->GetPathMtu() : std::nullopt), blocksize);
+    if (!bytes_per_packet) {
+      return {400, "Bad Request"};
+    }
+
+    std::unique_ptr<pipeline::RtpSink> sink;
+    if (interleaved) {
+      sink = std::make_unique<pipeline::InterleavedSink>(request.connection_output,
+                                                         ports.first);
+    } else {
+      sink = std::make_unique<pipeline::UdpSink>(udp_transport, egress_);
+    }
+    streamer = std::make_shared<pipeline::RtpStreamer>(
+        BuildStreamConfig(*bytes_per_packet, *frame_source_,
+                          chosen_transport->feedback),
+        packetizer_,
+        std::move(sink));
+
+    // Multicast stream is reported only while it's playing
+    if (interleaved) {
+      rtcp_.Add(streamer, request.connection_output, ports.second);
+    } else {
+      rtcp_.Add(streamer, udp_transport);
+    }
+  }
+
+  std::shared_ptr<Session> session = sessions_.Create(request.client_ip, ports,
+                                                      streamer);
+  session_timers_.Schedule(session->GetId(),
+                           std::chrono::steady_clock::now() + kSessionTimeout);
 
-  std::random_device rd;
-  std::mt19937 mersenne(rd());
-  session_id_ = mersenne();
+  std::ostringstream ssrc_oss;
+  ssrc_oss << std::hex << std::setw(8) << std::setfill('0')
+           << streamer->GetSynchronizationSource();
 
+  const std::string range = std::to_string(ports.first) + "-" +
+      std::to_string(ports.second);
   response.code = 200;
   response.description = "OK";
-  response.headers[kSessionHeader] = std::to_string(session_id_);
-  client_ports_ = ExtractClientPorts(request.headers.at(kTransportHeader));
-  response.headers[kTransportHeader] = "RTP/AVP;unicast;"s + "client_port=" +
-      std::to_string(client_ports_.first) + "-" +
-      std::to_string(client_ports_.second);
+  response.headers[rtsp::HeaderId::kSession] = std::to_string(session->GetId()) +
+      ";timeout=" + std::to_string(kSessionTimeout.count());
+  switch (chosen_transport->type) {
+    case Transport::Type::kUnicast: {
+      const std::pair<int, int> server_ports = udp_transport->GetServerPorts();
+      response.headers[rtsp::HeaderId::kTransport] =
+          (chosen_transport->feedback ? "RTP/AVPF"s : "RTP/AVP"s) + ";unicast;" +
+          "client_port=" + range + ";server_port=" +
+          std::to_string(server_ports.first) + "-" +
+          std::to_string(server_ports.second) +
+          (udp_transport->IsRtcpMuxed() ? ";RTCP-mux" : "") + ";ssrc=" + ssrc_oss.str();
+      break;
+    }
+    case Transport::Type::kMulticast:
+      response.headers[rtsp::HeaderId::kTransport] = "RTP/AVP;multicast;"s +
+          "destination=" + multicast_->group + ";port=" +
+          std::to_string(multicast_->port) + "-" +
+          std::to_string(multicast_->port + 1) + ";ttl=" +
+          std::to_string(multicast_->options.ttl) + ";ssrc=" + ssrc_oss.str();
+      break;
+    case Transport::Type::kInterleaved:
+      response.headers[rtsp::HeaderId::kTransport] = "RTP/AVP/TCP;unicast;"s +
+          "interleaved=" + range + ";ssrc=" + ssrc_oss.str();
+      break;
+  }
+  if (blocksize != nullptr) {
+    response.headers[rtsp::HeaderId::kBlocksize] = std::to_string(
+        streamer->GetBytesPerPacket() + rtp::mjpeg::kJpegHeaderSize);
+  }
 
   return response;
 }
 
 rtsp::Response Jpeg::ServePlay(const rtsp::Request &request) {
-  if (!CheckSession(request)) {
+  std::shared_ptr<Session> session = FindSession(request);
+  if (!session) {
     return {454, "Session Not Found"};
   }
 
-  client_connected_ = true;
-  {
-    std::lock_guard guard(play_worker_mutex_);
-    play_queue_.push(request);
+  if (session->Play()) {
+    if (session->GetStreamer() != multicast_streamer_) {
+      std::cout << "Start streaming to " << session->GetClientIp() << ":"
+                << session->GetClientPorts().first << std::endl;
+      publisher_.Subscribe(session->GetStreamer());
+    } else if (multicast_viewers_++ == 0) {
+      std::cout << "Start streaming to multicast group " << multicast_->group
+                << ":" << multicast_->port << std::endl;
+      rtcp_.Add(multicast_streamer_, multicast_->group, multicast_->port + 1);
+      publisher_.Subscribe(multicast_streamer_);
+    }
   }
-  play_worker_notifier_.notify_one();
 
   return {200, "OK",
       {
@@ -296,112 +691,146 @@ rtsp::Response Jpeg::ServePlay(const rtsp::Request &request) {
   };
 }
 
-rtsp::Response Jpeg::ServeTeardown(const rtsp::Request &request) {
-  if (!CheckSession(request)) {
+rtsp::Response Jpeg::ServeGetParameter(const rtsp::Request &request) {
+  std::shared_ptr<Session> session = FindSession(request);
+  if (!session) {
     return {454, "Session Not Found"};
   }
 
-  {
-    std::lock_guard guard(play_worker_mutex_);
-    teardown_ = true;
-    client_connected_ = false;
+  std::string body;
+  for (const std::string &name : SplitParameterLines(request.body)) {
+    std::optional<std::string> value = GetStreamParameter(*session->GetStreamer(),
+                                                          name);
+    if (!value) {
+      value = GetPipelineParameter(publisher_.GetStats(), name);
+    }
+    if (!value) {
+      return {451, "Parameter Not Understood"};
+    }
+    body += name + ": " + *value + "\r\n";
   }
-  play_worker_notifier_.notify_one();
 
-  return {200, "OK"};
+  if (body.empty()) {
+    return {200, "OK"};
+  }
+
+  return {200, "OK",
+          {
+              {"Content-Type", "text/parameters"},
+              {"Content-Length", std::to_string(body.size())}
+          },
+          body
+  };
 }
 
-void Jpeg::PlayWorkerThread() {
-  for (;;) {
-    std::unique_lock lock(play_worker_mutex_);
-    play_worker_notifier_.wait(lock,
-         [&play_queue = play_queue_, &play_worker_stop = play_worker_stop_] {
-           return (!play_queue.empty() || play_worker_stop);
-         }
-    );
-
-    if (play_worker_stop_) {
-      return;
-    }
+rtsp::Response Jpeg::ServeSetParameter(const rtsp::Request &request) {
+  std::shared_ptr<Session> session = FindSession(request);
+  if (!session) {
+    return {454, "Session Not Found"};
+  }
 
-    rtsp::Request play_request = play_queue_.front();
-    play_queue_.pop();
-    lock.unlock();
+  for (const std::string &line : SplitParameterLines(request.body)) {
+    const std::size_t colon_pos = line.find(':');
+    const std::string name = line.substr(0, colon_pos);
+    if (colon_pos == std::string::npos || name != "pacing_fraction") {
+      return {451, "Parameter Not Understood"};
+    }
 
-    HandlePlayRequest(play_request);
+    std::istringstream value_iss(line.substr(colon_pos + 1));
+    double pacing_fraction = 0;
+    if (!(value_iss >> pacing_fraction) || !(value_iss >> std::ws).eof() ||
+        pacing_fraction < 0 || pacing_fraction > pipeline::kMaxPacingFraction) {
+      return {451, "Parameter Not Understood"};
+    }
+    session->GetStreamer()->SetPacingFraction(pacing_fraction);
   }
-}
 
-void Jpeg::HandlePlayRequest(const rtsp::Request &request) {
-  std::cout << "Processing PLAY request..." << std::endl;
+  return {200, "OK"};
+}
 
-  const std::string client_addr = request.client_ip + ":" +
-      std::to_string(client_ports_.first);
+rtsp::Response Jpeg::ServeTeardown(const rtsp::Request &request) {
+  std::optional<uint32_t> session_id;
+  if (const std::string *session = request.headers.Find(rtsp::HeaderId::kSession)) {
+    session_id = ParseSessionId(*session);
+  }
 
-  sock::ClientSocket socket(sock::Type::kUdp);
+  std::shared_ptr<Session> session = (session_id ? sessions_.Remove(*session_id) :
+                                      nullptr);
+  if (!session) {
+    return {454, "Session Not Found"};
+  }
 
-  long double avg_time = 0;
-  try {
-    std::random_device rd;
-    std::mt19937 mersenne(rd());
-    std::uniform_int_distribution<uint32_t> distribution;
+  session_timers_.Cancel(session->GetId());
+  CloseSession(*session);
 
-    uint32_t timestamp = distribution(mersenne);
-    const uint32_t synchronization_source = distribution(mersenne);
-    uint16_t sequence_number = distribution(mersenne);
+  return {200, "OK"};
+}
 
-    uint64_t frame_counter = 0;
-    for (;;) {
-      auto start_time = std::chrono::steady_clock::now();
+void Jpeg::KeepAlive(const rtsp::Request &request) {
+  if (std::shared_ptr<Session> session = FindSession(request)) {
+    session->Touch();
+  }
+}
 
-      {
-        std::lock_guard guard(play_worker_mutex_);
-        if (teardown_) {
-          teardown_ = false;
-          break;
-        }
-        if (play_worker_stop_) {
-          break;
-        }
-      }
+void Jpeg::OnTimer(const std::chrono::steady_clock::time_point now) {
+  session_timers_.Advance(now, expired_sessions_);
 
-      const int kQuality = 70; // 0 - 100 %
-      Bytes jpeg_image = GrabImage(kQuality);
+  // Activity is checked only on expiry, so refreshing costs nothing
+  for (const TimerWheel::Id id : expired_sessions_) {
+    std::shared_ptr<Session> session = sessions_.Find(id);
+    if (!session) {
+      continue;
+    }
 
-      std::vector<rtp::mjpeg::Packet> mjpeg_packets = rtp::mjpeg::PackJpeg(
-          jpeg_image, Camera::GetInstance().getWidth(),
-          Camera::GetInstance().getHeight(), kQuality);
+    const auto deadline = session->GetLastActivity() + kSessionTimeout;
+    if (deadline > now) {
+      session_timers_.Schedule(id, deadline);
+      continue;
+    }
 
-      for (auto it = mjpeg_packets.begin(); it != mjpeg_packets.end(); ++it) {
-        const bool final = (it == std::prev(mjpeg_packets.end()));
-        rtp::Packet rtp_packet = rtp::mjpeg::PackToRtpPacket(
-            *it, final, sequence_number++, timestamp, synchronization_source);
-        socket.SendTo(rtp_packet.Serialize(), request.client_ip, client_ports_.first);
-      }
+    std::cout << "Session " << id << " timed out" << std::endl;
+    sessions_.Remove(id);
+    CloseSession(*session);
+  }
+}
 
-      const uint32_t kVideoClockRate = 90'000;
-      timestamp += kVideoClockRate / Camera::GetInstance().getFrameRate();
+void Jpeg::OnInterleavedData(uint8_t, Span<const Byte> data) {
+  // Clients send only RTCP over the connection
+  rtcp_.ReceivePacket(data);
+}
 
-      auto finish_time = std::chrono::steady_clock::now();
-      auto dur = finish_time - start_time;
-      uint32_t time_diff = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
-      avg_time = (avg_time * frame_counter + time_diff) / (frame_counter + 1);
-      ++frame_counter;
-    }
-  } catch (sock::SocketException &ex) {
-    std::cout << "Some error occurred during RTP packets translating: "
-              << ex.what() << std::endl;
+std::shared_ptr<Session> Jpeg::FindSession(const rtsp::Request &request) const {
+  const std::string *session = request.headers.Find(rtsp::HeaderId::kSession);
+  if (session == nullptr) {
+    return nullptr;
   }
 
-  std::cout << "Disconnecting RTP client " << client_addr << std::endl;
-  std::cout << "Average time for frame: " << avg_time << " ms" << std::endl;
-  client_connected_ = false;
+  std::optional<uint32_t> session_id = ParseSessionId(*session);
+  return (session_id ? sessions_.Find(*session_id) : nullptr);
 }
 
-bool Jpeg::CheckSession(const rtsp::Request &request) const {
-  const char kSessionHeader[] = "Session";
-  return (request.headers.count(kSessionHeader) &&
-          (std::stoul(request.headers.at(kSessionHeader)) == session_id_));
+void Jpeg::CloseSession(Session &session) {
+  if (session.GetStreamer() == multicast_streamer_) {
+    // Group is left without stream only after its last viewer
+    if (session.Close() && --multicast_viewers_ == 0) {
+      rtcp_.Remove(multicast_streamer_);
+      publisher_.Unsubscribe(multicast_streamer_);
+      std::cout << "Stop streaming to multicast group " << multicast_->group
+                << ":" << multicast_->port << std::endl;
+    }
+    return;
+  }
+
+  rtcp_.Remove(session.GetStreamer());
+  if (session.Close()) {
+    publisher_.Unsubscribe(session.GetStreamer());
+    std::cout << "Disconnecting RTP client " << session.GetClientIp() << ":"
+              << session.GetClientPorts().first
+              << ". Average time from capture to send: "
+              << session.GetStreamer()->GetAverageLatency() << " ms"
+              << ", dropped frames: " << session.GetStreamer()->GetDroppedFrames()
+              << std::endl;
+  }
 }
 
 } // namespace processing::servlets
@@ -26,17 +26,48 @@ SOFTWARE.
 
 #include "processing/servlet.h"
 
-#include <queue>
-#include <utility>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <string>
+#include <optional>
+#include <chrono>
+
+#include "video/frame_source.h"
+#include "pipeline/frame_publisher.h"
+#include "pipeline/frame_packetizer.h"
+#include "pipeline/rtp_egress.h"
+#include "pipeline/rtcp_channel.h"
+#include "pipeline/udp_transport.h"
+#include "sock/socket.h"
+#include "processing/session.h"
+#include "processing/session_table.h"
+#include "processing/timer_wheel.h"
 
 namespace processing::servlets {
 
 class Jpeg : public Servlet {
  public:
-  Jpeg();
+  /**
+   * @brief Configuration of the multicast stream shared by all multicast sessions
+   */
+  struct MulticastConfig {
+    std::string group; //!< Multicast group address
+    int port; //!< RTP port of the group. RTCP uses the next one
+    sock::MulticastOptions options; //!< Interface and TTL of sent datagrams
+  };
+
+  /**
+   * @brief Construct a new Jpeg object
+   *
+   * @param frame_source Source of frames to be streamed
+   * @param kernel_pacing If true, datagrams are paced by kernel (SO_TXTIME).
+   * Needs fq qdisc on the outgoing interface. Falls back to pacing in
+   * user space, if kernel doesn't support it
+   * @param multicast Multicast stream, which is advertised in SDP and can be
+   * set up with RTP/AVP;multicast. std::nullopt disables multicast
+   */
+  Jpeg(std::shared_ptr<video::FrameSource> frame_source, bool kernel_pacing,
+       std::optional<MulticastConfig> multicast);
 
   ~Jpeg() override;
 
@@ -46,42 +77,92 @@ class Jpeg : public Servlet {
 
   rtsp::Response ServePlay(const rtsp::Request &request) override;
 
-  rtsp::Response ServeTeardown(const rtsp::Request &request) override;
+  /**
+   * @brief Get parameters and statistics of the session stream
+   * @details Body has parameter names, one per line. Response body has
+   * "name: value" lines. Supported parameters:
+   * - packet_count, octet_count: sent RTP packets and payload bytes
+   * - bytes_per_packet, pacing_fraction: stream settings
+   * - dropped_frames, retransmitted_packets: frames dropped for the slow
+   *   session and packets sent again on its NACKs
+   * - fraction_lost, cumulative_lost, jitter_ms, round_trip_time_ms:
+   *   the last statistics from client RTCP receiver reports
+   * - capture_queue_depth, encode_queue_depth, send_queue_depth,
+   *   encode_dropped_frames, send_dropped_frames: statistics of the pipeline
+   *   shared by all sessions
+   *
+   * Empty body just checks the session, so clients can use it as keep-alive
+   */
+  rtsp::Response ServeGetParameter(const rtsp::Request &request) override;
 
- private:
-  const std::string kVideoTrackName = "track1"; //!< Name of the video track
+  /**
+   * @brief Change parameters of the session stream
+   * @details Body has "name: value" lines. Supported parameters:
+   * - pacing_fraction: part of the frame interval in [0, 0.8] range to spread
+   *   packets of the frame over. 0 disables pacing. Values out of the range
+   *   are rejected with 451
+   *
+   * Empty body just checks the session, so clients can use it as keep-alive
+   */
+  rtsp::Response ServeSetParameter(const rtsp::Request &request) override;
+
+  rtsp::Response ServeTeardown(const rtsp::Request &request) override;
 
-  bool client_connected_; //!< True, if one client is playing a video
-  bool teardown_; //!< True, if TEARDOWN was requested
-  uint32_t session_id_; //!< Session id. Only one session is supported
-  std::pair<int, int> client_ports_; //!< Pair of client RTP and RTCP ports
-  std::queue<rtsp::Request> play_queue_; //!< Queue of PLAY requests
-  std::thread play_worker_; //!< Thread for PLAY requests processing
-  bool play_worker_stop_; //!< True, if play_worker_ should stop
-  std::mutex play_worker_mutex_; //!< Mutex to interact with play_worker_
-  std::condition_variable play_worker_notifier_; //!< Cond. var. to interact with play_worker_
+  void KeepAlive(const rtsp::Request &request) override;
 
   /**
-   * @brief Extract PLAY request from queue and process it. Used in play_worker_
+   * @brief Close sessions, which clients didn't show activity for the timeout
+   *
+   * @param now Current time
    */
-  void PlayWorkerThread();
+  void OnTimer(std::chrono::steady_clock::time_point now) override;
 
   /**
-   * @brief Directly handle play request
+   * @brief Pass RTCP reports of interleaved streams to their streamers
    *
-   * @param request PLAY Request to handle
+   * @param channel Channel number
+   * @param data Received data
    */
-  void HandlePlayRequest(const rtsp::Request &request);
+  void OnInterleavedData(uint8_t channel, Span<const Byte> data) override;
+
+ private:
+  const std::string kVideoTrackName = "track1"; //!< Name of the video track
+
+  std::shared_ptr<video::FrameSource> frame_source_; //!< Source of frames
+  //! Multicast stream configuration or std::nullopt, if multicast is disabled
+  const std::optional<MulticastConfig> multicast_;
+  //! Captures and encodes frames once for all playing clients
+  pipeline::FramePublisher publisher_;
+  //! Splits every frame into packets once for all sessions
+  std::shared_ptr<pipeline::FramePacketizer> packetizer_;
+  //! Local ports of unicast sessions
+  std::shared_ptr<pipeline::PortPool> port_pool_;
+  //! Sends packets of all sessions together
+  std::shared_ptr<pipeline::RtpEgress> egress_;
+  //! Sends RTCP reports of all sessions and receives reports of their clients
+  pipeline::RtcpChannel rtcp_;
+  //! Stream of all multicast sessions or nullptr, if multicast is disabled
+  std::shared_ptr<pipeline::RtpStreamer> multicast_streamer_;
+  std::size_t multicast_viewers_; //!< Number of playing multicast sessions
+  SessionTable sessions_; //!< All set up sessions
+  TimerWheel session_timers_; //!< Timeouts of sessions by their ids
+  std::vector<TimerWheel::Id> expired_sessions_; //!< Buffer for expired timers
 
   /**
-   * @brief Check if provided session id is valid
+   * @brief Find session specified in the request Session header
    *
-   * @param request Request to check
+   * @param request Request with Session header
+   * @return Session if found
+   * @return nullptr in other way
+   */
+  std::shared_ptr<Session> FindSession(const rtsp::Request &request) const;
+
+  /**
+   * @brief Close session and stop streaming to it
    *
-   * @return true If session id is valid
-   * @return false In other way
+   * @param session Session, already removed from sessions_
    */
-  bool CheckSession(const rtsp::Request &request) const;
+  void CloseSession(Session &session);
 };
 
 } // namespace processing::servlets
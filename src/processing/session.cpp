@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "session.h"
+
+#include <utility>
+#include <algorithm>
+
+namespace processing {
+
+Session::Session(const uint32_t id, std::string client_ip,
+                 const std::pair<int, int> client_ports,
+                 std::shared_ptr<pipeline::RtpStreamer> streamer) :
+id_(id),
+client_ip_(std::move(client_ip)),
+client_ports_(client_ports),
+streamer_(std::move(streamer)),
+mutex_(),
+state_(State::kReady),
+last_activity_(std::chrono::steady_clock::now()) {}
+
+uint32_t Session::GetId() const {
+  return id_;
+}
+
+const std::string &Session::GetClientIp() const {
+  return client_ip_;
+}
+
+std::pair<int, int> Session::GetClientPorts() const {
+  return client_ports_;
+}
+
+Session::State Session::GetState() const {
+  std::lock_guard guard(mutex_);
+  return state_;
+}
+
+const std::shared_ptr<pipeline::RtpStreamer> &Session::GetStreamer() const {
+  return streamer_;
+}
+
+bool Session::Play() {
+  std::lock_guard guard(mutex_);
+  if (state_ != State::kReady) {
+    return false;
+  }
+
+  state_ = State::kPlaying;
+  return true;
+}
+
+bool Session::Close() {
+  std::lock_guard guard(mutex_);
+  const bool was_playing = (state_ == State::kPlaying);
+  state_ = State::kClosed;
+  return was_playing;
+}
+
+void Session::Touch() {
+  std::lock_guard guard(mutex_);
+  last_activity_ = std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point Session::GetLastActivity() const {
+  const auto last_report_time = streamer_->GetLastReportTime();
+
+  std::lock_guard guard(mutex_);
+  return std::max(last_activity_, last_report_time);
+}
+
+} // namespace processing
@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+#include "pipeline/rtp_streamer.h"
+
+namespace processing {
+
+/**
+ * @brief RTSP session of one client
+ * @details Holds transport parameters and RTP state of the client stream
+ */
+class Session {
+ public:
+  /**
+   * @brief Session lifecycle states
+   */
+  enum class State {
+    kReady, //!< Session is set up, but video is not playing
+    kPlaying, //!< Video is streaming to the client
+    kClosed //!< Session was torn down
+  };
+
+  /**
+   * @brief Construct a new Session object in kReady state
+   *
+   * @param id Unique session id
+   * @param client_ip Client ip address
+   * @param client_ports Pair of client RTP and RTCP ports or interleaved
+   * channels
+   * @param streamer Streamer sending frames to the client
+   */
+  Session(uint32_t id, std::string client_ip, std::pair<int, int> client_ports,
+          std::shared_ptr<pipeline::RtpStreamer> streamer);
+
+  /**
+   * @brief Get session id
+   *
+   * @return Session id
+   */
+  uint32_t GetId() const;
+
+  /**
+   * @brief Get client ip address
+   *
+   * @return Client ip address
+   */
+  const std::string &GetClientIp() const;
+
+  /**
+   * @brief Get client ports
+   *
+   * @return Pair of client RTP and RTCP ports or interleaved channels
+   */
+  std::pair<int, int> GetClientPorts() const;
+
+  /**
+   * @brief Get current state
+   *
+   * @return Session state
+   */
+  State GetState() const;
+
+  /**
+   * @brief Get streamer sending frames to the client
+   *
+   * @return RTP streamer of this session
+   */
+  const std::shared_ptr<pipeline::RtpStreamer> &GetStreamer() const;
+
+  /**
+   * @brief Switch session to kPlaying state
+   *
+   * @return true If session was ready and now must be subscribed to frames
+   * @return false If session is already playing or closed
+   */
+  bool Play();
+
+  /**
+   * @brief Switch session to kClosed state
+   *
+   * @return true If session was playing and now must be unsubscribed from frames
+   * @return false In other way
+   */
+  bool Close();
+
+  /**
+   * @brief Remember that client is alive
+   * @details Called on every client request with this session
+   */
+  void Touch();
+
+  /**
+   * @brief Get time of the last sign of life of the client
+   * @details Both RTSP requests and RTCP reports are counted
+   *
+   * @return Time of the last activity
+   */
+  std::chrono::steady_clock::time_point GetLastActivity() const;
+
+ private:
+  const uint32_t id_; //!< Session id
+  const std::string client_ip_; //!< Client ip address
+  //! Client RTP and RTCP ports or interleaved channels
+  const std::pair<int, int> client_ports_;
+  //! RTP sequence number, timestamp and SSRC of the session stream
+  const std::shared_ptr<pipeline::RtpStreamer> streamer_;
+  mutable std::mutex mutex_; //!< Mutex to protect state_ and last_activity_
+  State state_; //!< Current state
+  //! Time of the last RTSP request with this session
+  std::chrono::steady_clock::time_point last_activity_;
+};
+
+} // namespace processing
@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "session_table.h"
+
+#include <random>
+#include <mutex>
+
+namespace processing {
+
+std::optional<uint32_t> ParseSessionId(std::string_view header_value) {
+  while (!header_value.empty() && header_value.front() == ' ') {
+    header_value.remove_prefix(1);
+  }
+
+  uint64_t id = 0;
+  std::size_t i = 0;
+  for (; i < header_value.size() && header_value[i] >= '0' &&
+         header_value[i] <= '9'; ++i) {
+    id = id * 10 + (header_value[i] - '0');
+    if (id > UINT32_MAX) {
+      return std::nullopt;
+    }
+  }
+
+  if (i == 0 || (i < header_value.size() && header_value[i] != ';' &&
+                 header_value[i] != ' ')) {
+    return std::nullopt;
+  }
+
+  return static_cast<uint32_t>(id);
+}
+
+SessionTable::SessionTable() :
+mutex_(),
+sessions_() {}
+
+std::shared_ptr<Session> SessionTable::Create(
+    std::string client_ip, std::pair<int, int> client_ports,
+    std::shared_ptr<pipeline::RtpStreamer> streamer) {
+  static thread_local std::mt19937 mersenne(std::random_device{}());
+
+  std::unique_lock lock(mutex_);
+  uint32_t id = 0;
+  do {
+    id = mersenne();
+  } while (id == 0 || sessions_.count(id));
+
+  auto session = std::make_shared<Session>(id, std::move(client_ip), client_ports,
+                                          std::move(streamer));
+  sessions_.emplace(id, session);
+  return session;
+}
+
+std::shared_ptr<Session> SessionTable::Find(const uint32_t id) const {
+  std::shared_lock lock(mutex_);
+  auto it = sessions_.find(id);
+  return (it != sessions_.end() ? it->second : nullptr);
+}
+
+std::shared_ptr<Session> SessionTable::Remove(const uint32_t id) {
+  std::unique_lock lock(mutex_);
+  auto it = sessions_.find(id);
+  if (it == sessions_.end()) {
+    return nullptr;
+  }
+
+  std::shared_ptr<Session> session = std::move(it->second);
+  sessions_.erase(it);
+  return session;
+}
+
+std::vector<std::shared_ptr<Session>> SessionTable::Clear() {
+  std::unique_lock lock(mutex_);
+  std::vector<std::shared_ptr<Session>> sessions;
+  sessions.reserve(sessions_.size());
+  for (auto &[id, session] : sessions_) {
+    sessions.push_back(std::move(session));
+  }
+
+  sessions_.clear();
+  return sessions;
+}
+
+std::size_t SessionTable::Size() const {
+  std::shared_lock lock(mutex_);
+  return sessions_.size();
+}
+
+} // namespace processing
@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <shared_mutex>
+
+#include "session.h"
+
+namespace processing {
+
+/**
+ * @brief Parse session id from the value of RTSP Session header
+ * @details Parameters after ';' (like timeout) are ignored
+ *
+ * @param header_value Value of Session header
+ * @return Session id if value is valid
+ * @return std::nullopt in other way
+ */
+std::optional<uint32_t> ParseSessionId(std::string_view header_value);
+
+/**
+ * @brief Thread-safe table of RTSP sessions keyed by session id
+ * @details Used only on control paths. Streaming threads hold sessions
+ * streamers directly and never lock the table
+ */
+class SessionTable {
+ public:
+  SessionTable();
+
+  /**
+   * @brief Create new session with unique random id
+   *
+   * @param client_ip Client ip address
+   * @param client_ports Pair of client RTP and RTCP ports or interleaved
+   * channels
+   * @param streamer Streamer sending frames to the client
+   * @return Created session
+   */
+  std::shared_ptr<Session> Create(std::string client_ip,
+                                  std::pair<int, int> client_ports,
+                                  std::shared_ptr<pipeline::RtpStreamer> streamer);
+
+  /**
+   * @brief Find session by id
+   *
+   * @param id Session id
+   * @return Session if found
+   * @return nullptr in other way
+   */
+  std::shared_ptr<Session> Find(uint32_t id) const;
+
+  /**
+   * @brief Remove session from the table
+   *
+   * @param id Session id
+   * @return Removed session if it was found
+   * @return nullptr in other way
+   */
+  std::shared_ptr<Session> Remove(uint32_t id);
+
+  /**
+   * @brief Remove all sessions from the table
+   *
+   * @return All removed sessions
+   */
+  std::vector<std::shared_ptr<Session>> Clear();
+
+  /**
+   * @brief Get number of sessions
+   *
+   * @return Number of sessions
+   */
+  std::size_t Size() const;
+
+ private:
+  mutable std::shared_mutex mutex_; //!< Mutex to protect sessions_
+  std::unordered_map<uint32_t, std::shared_ptr<Session>> sessions_; //!< Id -> Session
+};
+
+} // namespace processing
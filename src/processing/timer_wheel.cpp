@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace processing {
+
+TimerWheel::TimerWheel(const Clock::duration tick, const Clock::time_point start) :
+tick_(tick),
+start_(start),
+current_tick_(0),
+levels_(),
+timers_() {}
+
+void TimerWheel::Schedule(const Id id, const Clock::time_point deadline) {
+  // Rounded up, so timer never expires before its deadline
+  const auto since_start = std::max(deadline - start_, Clock::duration::zero());
+  const uint64_t deadline_tick = (since_start + tick_ - Clock::duration(1)) / tick_;
+  const uint64_t expiry_tick = std::clamp(deadline_tick, current_tick_ + 1,
+                                          current_tick_ + kMaxTicks);
+
+  auto [it, inserted] = timers_.try_emplace(id);
+  Timer &timer = it->second;
+  if (!inserted) {
+    timer.slot->erase(timer.position);
+  }
+  timer.expiry_tick = expiry_tick;
+  Place(id, timer);
+}
+
+void TimerWheel::Cancel(const Id id) {
+  auto it = timers_.find(id);
+  if (it == timers_.end()) {
+    return;
+  }
+
+  it->second.slot->erase(it->second.position);
+  timers_.erase(it);
+}
+
+void TimerWheel::Advance(const Clock::time_point now, std::vector<Id> &expired) {
+  expired.clear();
+  const uint64_t now_tick = (now - start_) / tick_;
+
+  while (current_tick_ < now_tick) {
+    ++current_tick_;
+
+    // When lower bits wrap around, the next slot of the upper level comes
+    for (std::size_t level = 1; level < kLevelsCount; ++level) {
+      const uint64_t lower_bits = current_tick_ & ((uint64_t{1} << (kSlotBits * level)) - 1);
+      if (lower_bits != 0) {
+        break;
+      }
+      Cascade(levels_[level][(current_tick_ >> (kSlotBits * level)) & (kSlotsCount - 1)]);
+    }
+
+    Slot &slot = levels_[0][current_tick_ & (kSlotsCount - 1)];
+    for (const Id id : slot) {
+      timers_.erase(id);
+      expired.push_back(id);
+    }
+    slot.clear();
+  }
+}
+
+std::size_t TimerWheel::Size() const {
+  return timers_.size();
+}
+
+void TimerWheel::Place(const Id id, Timer &timer) {
+  // The lowest level, which range covers the distance to expiry
+  const uint64_t distance = timer.expiry_tick - current_tick_;
+  std::size_t level = 0;
+  while (level + 1 < kLevelsCount && distance >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+
+  Slot &slot = levels_[level][(timer.expiry_tick >> (kSlotBits * level)) &
+                              (kSlotsCount - 1)];
+  timer.slot = &slot;
+  timer.position = slot.insert(slot.end(), id);
+}
+
+void TimerWheel::Cascade(Slot &slot) {
+  Slot timers;
+  timers.swap(slot);
+  for (const Id id : timers) {
+    Place(id, timers_.at(id));
+  }
+}
+
+} // namespace processing
@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+namespace processing {
+
+/**
+ * @brief Hierarchical timer wheel
+ * @details Every level has kSlotsCount slots, each covering kSlotsCount times
+ * more ticks than a slot of the previous level. Scheduling and cancelling are
+ * O(1), advancing costs O(1) per tick plus cascading of timers to lower
+ * levels, which happens at most once per level for every timer. Not
+ * thread-safe
+ */
+class TimerWheel {
+ public:
+  using Id = uint32_t; //!< Timer identifier
+  using Clock = std::chrono::steady_clock; //!< Clock of deadlines
+
+  /**
+   * @brief Construct a new TimerWheel object
+   *
+   * @param tick Precision of timers
+   * @param start Time of the tick 0
+   */
+  TimerWheel(Clock::duration tick, Clock::time_point start);
+
+  /**
+   * @brief Schedule timer, replacing previous timer with the same id
+   * @details Deadlines beyond the wheel range are brought closer
+   *
+   * @param id Timer identifier
+   * @param deadline Time after which timer expires
+   */
+  void Schedule(Id id, Clock::time_point deadline);
+
+  /**
+   * @brief Cancel timer if it's scheduled
+   *
+   * @param id Timer identifier
+   */
+  void Cancel(Id id);
+
+  /**
+   * @brief Advance the wheel and collect expired timers
+   *
+   * @param now Current time
+   * @param expired Filled with ids of expired timers. Old content is removed
+   */
+  void Advance(Clock::time_point now, std::vector<Id> &expired);
+
+  /**
+   * @brief Get number of scheduled timers
+   *
+   * @return Number of timers
+   */
+  std::size_t Size() const;
+
+ private:
+  //! Number of bits of tick number handled by one level
+  static constexpr unsigned int kSlotBits = 6;
+  static constexpr std::size_t kSlotsCount = 1 << kSlotBits; //!< Slots in level
+  static constexpr std::size_t kLevelsCount = 4; //!< Number of levels
+  //! Max distance of deadline in ticks
+  static constexpr uint64_t kMaxTicks = (uint64_t{1} << (kSlotBits * kLevelsCount)) - 1;
+
+  using Slot = std::list<Id>; //!< Timers of one slot
+
+  /**
+   * @brief Position of the scheduled timer
+   */
+  struct Timer {
+    uint64_t expiry_tick; //!< Tick, when the timer expires
+    Slot *slot; //!< Slot holding the timer
+    Slot::iterator position; //!< Position in the slot
+  };
+
+  const Clock::duration tick_; //!< Precision of timers
+  const Clock::time_point start_; //!< Time of the tick 0
+  uint64_t current_tick_; //!< The last processed tick
+  std::array<std::array<Slot, kSlotsCount>, kLevelsCount> levels_; //!< Slots
+  std::unordered_map<Id, Timer> timers_; //!< All scheduled timers
+
+  /**
+   * @brief Put timer into the slot matching its expiry tick
+   *
+   * @param id Timer identifier
+   * @param timer Timer with set expiry tick
+   */
+  void Place(Id id, Timer &timer);
+
+  /**
+   * @brief Move timers of the slot to the lower levels
+   *
+   * @param slot Slot to empty
+   */
+  void Cascade(Slot &slot);
+};
+
+} // namespace processing
@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "packet.h"
+
+#include <cstring>
+
+namespace {
+
+//! RTCP version
+const uint8_t kVersion = 2;
+//! Size of the common header of all RTCP packets
+const std::size_t kHeaderSize = 4;
+//! Size of sender report without report blocks
+const std::size_t kSenderReportSize = kHeaderSize + 4 + 20;
+//! Size of receiver report without report blocks
+const std::size_t kReceiverReportSize = kHeaderSize + 4;
+//! Size of one report block
+const std::size_t kReportBlockSize = 24;
+//! Size of feedback message without feedback control information
+const std::size_t kFeedbackSize = kHeaderSize + 8;
+//! Size of one generic NACK item
+const std::size_t kGenericNackSize = 4;
+//! Feedback message type of generic NACK
+const uint8_t kGenericNackFormat = 1;
+//! Type of the CNAME item of source description
+const uint8_t kCanonicalNameItem = 1;
+//! Seconds between 1900 (NTP epoch) and 1970 (Unix epoch)
+const uint64_t kNtpEpochOffset = 2'208'988'800;
+
+/**
+ * @brief Read functions for integers of different length in network byte order
+ *
+ * @param src Source with enough bytes
+ * @return Unsigned integer
+ */
+uint16_t Read16(const Byte *src) {
+  return static_cast<uint16_t>((src[0] << 8) | src[1]);
+}
+
+uint32_t Read24(const Byte *src) {
+  return (static_cast<uint32_t>(src[0]) << 16) |
+         (static_cast<uint32_t>(src[1]) << 8) |
+         static_cast<uint32_t>(src[2]);
+}
+
+uint32_t Read32(const Byte *src) {
+  return (static_cast<uint32_t>(src[0]) << 24) | Read24(src + 1);
+}
+
+/**
+ * @brief Write common header of RTCP packet
+ *
+ * @param dst Destination with at least kHeaderSize bytes
+ * @param count Number of report blocks or source chunks
+ * @param type Packet type
+ * @param size Size of the whole packet, multiple of 4
+ * @return Pointer past the header
+ */
+Byte *WriteHeader(Byte *dst, const uint8_t count, const rtcp::PacketType type,
+                  const std::size_t size) {
+  *dst++ = static_cast<Byte>((kVersion << 6) | count);
+  *dst++ = static_cast<Byte>(type);
+  return rtp::Write16(dst, static_cast<uint16_t>(size / 4 - 1));
+}
+
+/**
+ * @brief Parse report block
+ *
+ * @param src Source with at least kReportBlockSize bytes
+ * @return Report block
+ */
+rtcp::ReportBlock ParseReportBlock(const Byte *src) {
+  rtcp::ReportBlock block;
+  block.source = Read32(src);
+  block.fraction_lost = src[4];
+
+  // Cumulative number is 24-bit signed
+  const uint32_t cumulative_lost = Read24(src + 5);
+  block.cumulative_lost = static_cast<int32_t>(cumulative_lost << 8) >> 8;
+
+  block.highest_sequence_number = Read32(src + 8);
+  block.jitter = Read32(src + 12);
+  block.last_sender_report = Read32(src + 16);
+  block.delay_since_last_sender_report = Read32(src + 20);
+
+  return block;
+}
+
+} // namespace
+
+namespace rtcp {
+
+ParseError::ParseError(std::string_view message) :
+    std::runtime_error(message.data()) {}
+
+std::size_t SenderReport::GetSerializedSize() const {
+  return kSenderReportSize;
+}
+
+std::size_t SenderReport::SerializeInto(Span<Byte> buffer) const {
+  const std::size_t size = GetSerializedSize();
+  rtp::CheckBufferSize(buffer, size);
+
+  Byte *dst = WriteHeader(buffer.data(), 0, PacketType::kSenderReport, size);
+  dst = rtp::Write32(dst, synchronization_source);
+  dst = rtp::Write32(dst, static_cast<uint32_t>(ntp_timestamp >> 32));
+  dst = rtp::Write32(dst, static_cast<uint32_t>(ntp_timestamp));
+  dst = rtp::Write32(dst, rtp_timestamp);
+  dst = rtp::Write32(dst, packet_count);
+  rtp::Write32(dst, octet_count);
+
+  return size;
+}
+
+std::size_t SourceDescription::GetSerializedSize() const {
+  // SSRC, CNAME item type, length and text, end of items, padding to 32 bits
+  const std::size_t chunk_size = 4 + 2 + canonical_name.size() + 1;
+  return kHeaderSize + (chunk_size + 3) / 4 * 4;
+}
+
+std::size_t SourceDescription::SerializeInto(Span<Byte> buffer) const {
+  if (canonical_name.size() > UINT8_MAX) {
+    throw std::length_error("CNAME is too long");
+  }
+
+  const std::size_t size = GetSerializedSize();
+  rtp::CheckBufferSize(buffer, size);
+
+  Byte *dst = WriteHeader(buffer.data(), 1, PacketType::kSourceDescription, size);
+  dst = rtp::Write32(dst, synchronization_source);
+  *dst++ = kCanonicalNameItem;
+  *dst++ = static_cast<Byte>(canonical_name.size());
+  std::memcpy(dst, canonical_name.data(), canonical_name.size());
+  dst += canonical_name.size();
+
+  // End of items and padding are zeros
+  std::memset(dst, 0, buffer.data() + size - dst);
+
+  return size;
+}
+
+void ParseFeedback(Span<const Byte> compound, Feedback &feedback) {
+  feedback.blocks.clear();
+  feedback.nacks.clear();
+
+  while (!compound.empty()) {
+    if (compound.size() < kHeaderSize || (compound[0] >> 6) != kVersion) {
+      throw ParseError("Invalid RTCP header");
+    }
+
+    const std::size_t size = (((compound[2] << 8) | compound[3]) + 1) * 4;
+    if (size > compound.size()) {
+      throw ParseError("RTCP packet is truncated");
+    }
+
+    // Count is feedback message type for feedback packets
+    const uint8_t count = compound[0] & 0x1F;
+    const auto type = static_cast<PacketType>(compound[1]);
+    std::size_t first_block = 0;
+    if (type == PacketType::kSenderReport) {
+      first_block = kSenderReportSize;
+    } else if (type == PacketType::kReceiverReport) {
+      first_block = kReceiverReportSize;
+    }
+
+    if (first_block != 0) {
+      if (first_block + count * kReportBlockSize > size) {
+        throw ParseError("RTCP report blocks are truncated");
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        feedback.blocks.push_back(ParseReportBlock(
+            compound.data() + first_block + i * kReportBlockSize));
+      }
+    } else if (type == PacketType::kTransportFeedback &&
+               count == kGenericNackFormat) {
+      if (size < kFeedbackSize) {
+        throw ParseError("RTCP feedback is truncated");
+      }
+      const uint32_t media_source = Read32(compound.data() + kHeaderSize + 4);
+      for (std::size_t offset = kFeedbackSize; offset + kGenericNackSize <= size;
+           offset += kGenericNackSize) {
+        feedback.nacks.push_back({media_source, Read16(compound.data() + offset),
+                                  Read16(compound.data() + offset + 2)});
+      }
+    }
+
+    compound = compound.subspan(size);
+  }
+}
+
+uint64_t ToNtpTimestamp(const std::chrono::system_clock::time_point time) {
+  const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time.time_since_epoch()).count();
+  const uint64_t seconds = since_epoch / 1'000'000'000 + kNtpEpochOffset;
+  const uint64_t fraction = (static_cast<uint64_t>(since_epoch % 1'000'000'000) << 32) /
+                            1'000'000'000;
+
+  return (seconds << 32) | fraction;
+}
+
+ReceptionStats ToReceptionStats(const ReportBlock &block, const uint32_t clock_rate,
+                                const uint64_t arrival_time) {
+  ReceptionStats stats;
+  stats.fraction_lost = block.fraction_lost / 256.0;
+  stats.cumulative_lost = block.cumulative_lost;
+  stats.highest_sequence_number = block.highest_sequence_number;
+  stats.jitter_ms = block.jitter * 1000.0 / clock_rate;
+
+  // RTT = A - LSR - DLSR, all in middle 32 bits of NTP timestamp
+  if (block.last_sender_report != 0) {
+    const auto arrival = static_cast<uint32_t>(arrival_time >> 16);
+    const auto round_trip_time = static_cast<int32_t>(
+        arrival - block.last_sender_report - block.delay_since_last_sender_report);
+    if (round_trip_time >= 0) {
+      stats.round_trip_time_ms = round_trip_time * 1000.0 / 65536;
+    }
+  }
+
+  return stats;
+}
+
+} // namespace rtcp
@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <stdexcept>
+#include <string_view>
+
+#include "byte.h"
+#include "span.h"
+#include "rtp/serializable.h"
+
+namespace rtcp {
+
+/**
+ * @brief Exception, indicating that RTCP packet is malformed
+ */
+class ParseError : public std::runtime_error {
+ public:
+  ParseError(std::string_view message);
+};
+
+/**
+ * @brief RTCP packet types
+ */
+enum class PacketType : uint8_t {
+  kSenderReport = 200,
+  kReceiverReport = 201,
+  kSourceDescription = 202,
+  kGoodbye = 203,
+  kApplicationDefined = 204,
+  kTransportFeedback = 205 //!< RTPFB of RFC 4585
+};
+
+/**
+ * @brief Reception report about one synchronization source
+ */
+struct ReportBlock {
+  uint32_t source; //!< SSRC of the reported source
+  uint8_t fraction_lost; //!< Part of packets lost since previous report in 1/256
+  int32_t cumulative_lost; //!< Number of packets lost since the beginning
+  uint32_t highest_sequence_number; //!< Extended highest sequence number received
+  uint32_t jitter; //!< Interarrival jitter in timestamp units
+  //! Middle 32 bits of NTP timestamp of the last received sender report (LSR)
+  uint32_t last_sender_report;
+  //! Delay since the last sender report in 1/65536 seconds (DLSR)
+  uint32_t delay_since_last_sender_report;
+};
+
+/**
+ * @brief Generic NACK item (RFC 4585) about lost packets of one source
+ */
+struct GenericNack {
+  uint32_t media_source; //!< SSRC of the source, which packets are lost
+  uint16_t packet_id; //!< Sequence number of the lost packet (PID)
+  //! Bit i set means packet_id + i + 1 is lost too (BLP)
+  uint16_t lost_bitmask;
+};
+
+/**
+ * @brief Feedback of the receiver found in compound RTCP packet
+ */
+struct Feedback {
+  std::vector<ReportBlock> blocks; //!< Blocks of sender and receiver reports
+  std::vector<GenericNack> nacks; //!< Items of generic NACKs
+};
+
+/**
+ * @brief Sender report without reception report blocks
+ */
+struct SenderReport : rtp::Serializable {
+  uint32_t synchronization_source; //!< SSRC of the sender
+  uint64_t ntp_timestamp; //!< Wallclock time of the report
+  uint32_t rtp_timestamp; //!< RTP timestamp of the same moment
+  uint32_t packet_count; //!< Number of sent RTP packets
+  uint32_t octet_count; //!< Number of sent RTP payload bytes
+
+  std::size_t GetSerializedSize() const override;
+
+  std::size_t SerializeInto(Span<Byte> buffer) const override;
+};
+
+/**
+ * @brief Source description with CNAME item of one source
+ */
+struct SourceDescription : rtp::Serializable {
+  uint32_t synchronization_source; //!< SSRC of the source
+  std::string canonical_name; //!< CNAME, up to 255 bytes
+
+  std::size_t GetSerializedSize() const override;
+
+  std::size_t SerializeInto(Span<Byte> buffer) const override;
+};
+
+/**
+ * @brief Extract report blocks of all sender and receiver reports and items
+ * of all generic NACKs
+ * @details Other packets of the compound packet are skipped
+ * @throws ParseError if packet is malformed
+ *
+ * @param compound Compound RTCP packet
+ * @param feedback Filled with found blocks and items. Old content is removed
+ */
+void ParseFeedback(Span<const Byte> compound, Feedback &feedback);
+
+/**
+ * @brief Convert time to 64-bit NTP timestamp
+ *
+ * @param time Wallclock time
+ * @return Seconds since 1900 in high 32 bits and fraction of second in low ones
+ */
+uint64_t ToNtpTimestamp(std::chrono::system_clock::time_point time);
+
+/**
+ * @brief Reception statistics of the stream reported by its receiver
+ */
+struct ReceptionStats {
+  double fraction_lost; //!< Part of packets lost since previous report
+  int32_t cumulative_lost; //!< Number of packets lost since the beginning
+  uint32_t highest_sequence_number; //!< Extended highest sequence number received
+  double jitter_ms; //!< Interarrival jitter in milliseconds
+  //! Round-trip time in milliseconds, if receiver got sender reports
+  std::optional<double> round_trip_time_ms;
+};
+
+/**
+ * @brief Get statistics from the report block
+ *
+ * @param block Report block about the stream
+ * @param clock_rate RTP clock rate of the stream
+ * @param arrival_time NTP timestamp of the report arrival
+ * @return Reception statistics
+ */
+ReceptionStats ToReceptionStats(const ReportBlock &block, uint32_t clock_rate,
+                                uint64_t arrival_time);
+
+} // namespace rtcp
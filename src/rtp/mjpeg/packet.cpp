@@ -24,150 +24,174 @@ SOFTWARE.
 
 #include "packet.h"
 
-#include <algorithm>
+#include <cstring>
 
 namespace {
 
+//! Size of the Restart Marker header
+const std::size_t kRestartMarkerHeaderSize = 4;
+//! Size of the Quantization Table header without table data
+const std::size_t kQuantizationTableHeaderSize = 4;
+
 /**
  * @brief Get entropy encoded segment (main data) of jpeg image
  *
  * @param jpeg_image Bytes representing jpeg image
- * @return Entropy encoded segment
+ * @return View of the entropy encoded segment with EOI marker
  */
-Bytes GetEntropyEncodedSegment(const Bytes &jpeg_image) {
-  auto sos_begin = jpeg_image.begin();
-  for (; sos_begin != jpeg_image.end(); ++sos_begin) {
-    if ((*sos_begin == 0xFF) &&
-        (sos_begin != std::prev(jpeg_image.end())) &&
-        (*std::next(sos_begin) == 0xDA)) {
-      break;
-    }
-  }
+Span<const Byte> GetEntropyEncodedSegment(const Bytes &jpeg_image) {
+  const std::size_t size = jpeg_image.size();
 
-  if (sos_begin == jpeg_image.end()) {
+  std::size_t sos_pos = 0;
+  while (sos_pos + 3 < size &&
+         !(jpeg_image[sos_pos] == 0xFF && jpeg_image[sos_pos + 1] == 0xDA)) {
+    ++sos_pos;
+  }
+  if (sos_pos + 3 >= size) {
     return {};
   }
 
-  uint16_t length = (uint16_t (*(sos_begin + 2)) << 8) | uint16_t (*(sos_begin + 3));
-  auto encoded_data_begin = sos_begin + length + 2;
+  const uint16_t length = (uint16_t(jpeg_image[sos_pos + 2]) << 8) |
+      uint16_t(jpeg_image[sos_pos + 3]);
+  const std::size_t encoded_data_begin = sos_pos + length + 2;
+  if (encoded_data_begin >= size) {
+    return {};
+  }
 
-  auto encoded_data_end = jpeg_image.rbegin();
-  for (; encoded_data_end != std::reverse_iterator(encoded_data_begin); ++encoded_data_end) {
-    if ((*encoded_data_end == 0xFF) &&
-        (encoded_data_end != jpeg_image.rend()) &&
-        (*std::prev(encoded_data_end) == 0xD9)) {
+  std::size_t encoded_data_end = size;
+  for (std::size_t pos = size - 1; pos > encoded_data_begin; --pos) {
+    if (jpeg_image[pos - 1] == 0xFF && jpeg_image[pos] == 0xD9) {
+      encoded_data_end = pos + 1;
       break;
     }
   }
 
-  return {encoded_data_begin, encoded_data_end.base() + 3};
+  return Span<const Byte>(jpeg_image).subspan(encoded_data_begin,
+                                              encoded_data_end - encoded_data_begin);
 }
 
 /**
- * @brief Pack given data to one MJPEG over RTP packet
+ * @brief Build MJPEG over RTP header
  *
- * @param data Pointer to the whole JPEG data
- * @param start Start pos for current packet
- * @param count Number of bytes to read
- * @param dimensions Pair of width and height
+ * @param fragment_offset Offset of the packet data in the JPEG data
+ * @param width Image width
+ * @param height Image height
  * @param quality JPEG quality in [0-100] range
- * @return MJPEG over RTP packet with part of JPEG image data
+ * @return MJPEG over RTP header
  */
-rtp::mjpeg::Packet PackOne(const Byte *const data,
-                           const int start,
-                           const int count,
-                           const unsigned int width,
-                           const unsigned int height,
-                           const int quality) {
+rtp::mjpeg::Header BuildHeader(const unsigned int fragment_offset,
+                               const unsigned int width,
+                               const unsigned int height,
+                               const int quality) {
   rtp::mjpeg::Header header;
   header.type_specific = 0;
-  header.fragment_offset = start;
+  header.fragment_offset = fragment_offset;
   header.type = 1; // Because horiz. and vert. samp. fact. are 2, 1, 1
   header.quality = quality;
   header.width = width / 8;
   header.height = height / 8;
+  header.restart_marker_header = 0;
+  header.quantization_table_header = {};
 
-  rtp::mjpeg::Packet packet;
-  packet.header = header;
-  packet.payload = {data + start, data + start + count}; // ???
-  return packet;
+  return header;
+}
+
+/**
+ * @brief Build RTP header for MJPEG over RTP packet
+ *
+ * @param final Flag of last JPEG part in the packet
+ * @param sequence_number Number of packet
+ * @param timestamp The timestamp of whole frame
+ * @param synchronization_source Random id of the current RTP source
+ * @return RTP header
+ */
+rtp::Header BuildRtpHeader(const bool final,
+                           const uint16_t sequence_number,
+                           const uint32_t timestamp,
+                           const uint32_t synchronization_source) {
+  rtp::Header header;
+  header.version = 2;
+  header.padding = 0;
+  header.extension = 0;
+  header.csrc_count = 0;
+  header.marker = (final ? 1 : 0);
+  header.payload_type = 26;
+  header.sequence_number = sequence_number;
+  header.timestamp = timestamp;
+  header.synchronization_source = synchronization_source;
+  header.contributing_sources = {};
+  header.extension_header = {};
+
+  return header;
 }
 
 } // namespace
 
 namespace rtp::mjpeg {
 
-Bytes Packet::Serialize() const {
-  Bytes bytes;
-  bytes.reserve(8);
-
-  bytes.push_back(header.type_specific);
-  Bytes serialized_tmp = Serialize24(header.fragment_offset);
-  bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-  bytes.push_back(header.type);
-  bytes.push_back(header.quality);
-  bytes.push_back(header.width);
-  bytes.push_back(header.height);
-  if (header.type >= 64 && header.type < 128) {
-    serialized_tmp = Serialize32(header.restart_marker_header);
-    bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
+std::size_t Header::GetSerializedSize() const {
+  std::size_t size = kJpegHeaderSize;
+  if (type >= 64 && type < 128) {
+    size += kRestartMarkerHeaderSize;
   }
-  if (header.quality >= 128) {
-    bytes.push_back(header.quantization_table_header.mbz);
-    bytes.push_back(header.quantization_table_header.precision);
-    bytes.push_back(header.quantization_table_header.length);
-    bytes.insert(bytes.end(),
-                 header.quantization_table_header.data.begin(),
-                 header.quantization_table_header.data.end());
+  if (quality >= 128) {
+    size += kQuantizationTableHeaderSize + quantization_table_header.data.size();
   }
 
-  bytes.insert(bytes.end(), payload.begin(), payload.end());
+  return size;
+}
 
-  return bytes;
+std::size_t Header::SerializeInto(Span<Byte> buffer) const {
+  const std::size_t size = GetSerializedSize();
+  CheckBufferSize(buffer, size);
+
+  Byte *dst = buffer.data();
+  *dst++ = type_specific;
+  dst = Write24(dst, fragment_offset);
+  *dst++ = type;
+  *dst++ = quality;
+  *dst++ = width;
+  *dst++ = height;
+  if (type >= 64 && type < 128) {
+    dst = Write32(dst, restart_marker_header);
+  }
+  if (quality >= 128) {
+    *dst++ = quantization_table_header.mbz;
+    *dst++ = quantization_table_header.precision;
+    dst = Write16(dst, quantization_table_header.length);
+    std::memcpy(dst, quantization_table_header.data.data(),
+                quantization_table_header.data.size());
+  }
+
+  return size;
 }
 
-std::vector<Packet> PackJpeg(const Bytes &jpeg, const unsigned int width,
-                             const unsigned int height, const int quality) {
-  const int kMaxBytesPerPacket = 512;
-  std::vector<Packet> packets;
-  Bytes segment = GetEntropyEncodedSegment(jpeg);
-  packets.reserve((segment.size() / kMaxBytesPerPacket) + 1);
+void PackJpeg(const Bytes &jpeg, const std::size_t bytes_per_packet,
+              std::vector<Fragment> &fragments) {
+  fragments.clear();
+  const Span<const Byte> segment = GetEntropyEncodedSegment(jpeg);
 
   for (std::size_t begin_index = 0;
        begin_index < segment.size();
-       begin_index += kMaxBytesPerPacket) {
-    const int count = std::min(static_cast<int>(segment.size() - begin_index),
-                               kMaxBytesPerPacket);
-    packets.push_back(
-        PackOne(segment.data(), begin_index, count,
-                width, height, quality)
-    );
+       begin_index += bytes_per_packet) {
+    const Span<const Byte> part = segment.subspan(begin_index, bytes_per_packet);
+    const bool final = (begin_index + part.size() == segment.size());
+    fragments.push_back({part, static_cast<unsigned int>(begin_index), final});
   }
-
-  return packets;
 }
 
-rtp::Packet PackToRtpPacket(const Packet &mjpeg_packet, const bool final,
-                            const uint16_t sequence_number,
-                            const uint32_t timestamp,
-                            const uint32_t synchronization_source) {
-  rtp::Header header;
-  header.version = 2;
-  header.padding = 0;
-  header.extension = 0;
-  header.csrc_count = 0;
-  header.marker = (final ? 1 : 0);
-  header.payload_type = 26;
-  header.sequence_number = sequence_number;
-  header.timestamp = timestamp;
-  header.synchronization_source = synchronization_source;
-  header.contributing_sources = {};
-  header.extension_header = {};
-
-  rtp::Packet packet;
-  packet.header = header;
-  packet.payload = mjpeg_packet.Serialize();
-  return packet;
+std::size_t SerializeHeadersInto(const Fragment &fragment, const unsigned int width,
+                                 const unsigned int height, const int quality,
+                                 const uint16_t sequence_number,
+                                 const uint32_t timestamp,
+                                 const uint32_t synchronization_source,
+                                 Span<Byte> buffer) {
+  const std::size_t size = BuildRtpHeader(
+      fragment.final, sequence_number, timestamp,
+      synchronization_source).SerializeInto(buffer);
+
+  return size + BuildHeader(fragment.offset, width, height, quality).SerializeInto(
+      buffer.subspan(size));
 }
 
 } // namespace rtp::mjpeg
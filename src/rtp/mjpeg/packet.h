@@ -25,6 +25,7 @@ SOFTWARE.
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 
 #include "rtp/serializable.h"
@@ -35,7 +36,7 @@ namespace rtp::mjpeg {
 /**
  * @brief An MJPEG over RTP header
  */
-struct Header {
+struct Header : Serializable {
   uint8_t type_specific; //!< Interpretation depends on the value of the type field
   //! The offset in bytes of the current packet in the JPEG frame data
   unsigned int fragment_offset: 24;
@@ -52,42 +53,67 @@ struct Header {
     uint16_t length; //!< The length of data in bytes. Equals to data.size()
     Bytes data; //!< Quantization table data
   } quantization_table_header;
+
+  std::size_t GetSerializedSize() const override;
+
+  std::size_t SerializeInto(Span<Byte> buffer) const override;
 };
 
 /**
- * @brief An MJPEG over RTP packet
+ * @brief Part of the JPEG image, which fits into one packet
  */
-struct Packet : Serializable {
-  Header header;
-  Bytes payload;
-
-  Bytes Serialize() const override;
+struct Fragment {
+  Span<const Byte> data; //!< View of the image data
+  unsigned int offset; //!< Offset of the data in the entropy encoded segment
+  bool final; //!< True, if it's the last fragment of the image
 };
 
+//! Size of RTP header written by SerializeHeadersInto()
+const std::size_t kRtpHeaderSize = 12;
+//! Size of main JPEG header written by SerializeHeadersInto()
+const std::size_t kJpegHeaderSize = 8;
+//! Size of RTP and main JPEG headers written by SerializeHeadersInto()
+const std::size_t kHeadersSize = kRtpHeaderSize + kJpegHeaderSize;
+//! Default number of JPEG bytes in one packet. Packet fits into Ethernet MTU
+const std::size_t kDefaultBytesPerPacket = 1400;
+//! Min number of JPEG bytes in one packet
+const std::size_t kMinBytesPerPacket = 64;
+//! Max number of JPEG bytes in one packet, limited by UDP datagram size
+const std::size_t kMaxBytesPerPacket = 65'507 - kHeadersSize;
+
 /**
- * @brief Pack and split JPEG image into MJPEG over RTP packets
+ * @brief Split JPEG image into fragments without copying
+ * @details Every fragment except the final one has exactly bytes_per_packet
+ * bytes, so headers followed by fragments form packets with fixed stride of
+ * kHeadersSize + bytes_per_packet. This lets the kernel split them with UDP GSO
  *
- * @param jpeg Bytes of the JPEG image
- * @param width Image width
- * @param height Image height
- * @return Vector of MJPEG packets
+ * @param jpeg Bytes of the JPEG image. Must outlive fragments
+ * @param bytes_per_packet Number of image bytes in one fragment, in
+ * [kMinBytesPerPacket, kMaxBytesPerPacket] range
+ * @param fragments Filled with views of the image. Old content is removed
  */
-std::vector<Packet> PackJpeg(const Bytes &jpeg, unsigned int width,
-                             unsigned int height, int quality);
+void PackJpeg(const Bytes &jpeg, std::size_t bytes_per_packet,
+              std::vector<Fragment> &fragments);
 
 /**
- * @brief Pack MJPEG over RTP packet to the RTP packet
+ * @brief Serialize RTP and MJPEG over RTP headers of the fragment
+ * @details Fragment data should be sent right after the headers
  *
- * @param mjpeg_packet MJPEG over RTP packet
- * @param final Flag of last JPEG part in mjpeg_packet
+ * @param fragment Fragment of the image
+ * @param width Image width
+ * @param height Image height
+ * @param quality JPEG quality in [0-100] range
  * @param sequence_number Number of packet, increments by one for each packet,
  * init value should be random
  * @param timestamp The timestamp of whole frame
  * @param synchronization_source Random id of the current RTP source
- * @return RTP packet
+ * @param buffer Destination with at least kHeadersSize bytes
+ * @return Number of written bytes
  */
-rtp::Packet PackToRtpPacket(const mjpeg::Packet &mjpeg_packet, bool final,
-                            uint16_t sequence_number, uint32_t timestamp,
-                            uint32_t synchronization_source);
+std::size_t SerializeHeadersInto(const Fragment &fragment, unsigned int width,
+                                 unsigned int height, int quality,
+                                 uint16_t sequence_number, uint32_t timestamp,
+                                 uint32_t synchronization_source,
+                                 Span<Byte> buffer);
 
 } // namespace rtp::mjpeg
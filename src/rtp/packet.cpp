@@ -24,40 +24,72 @@ SOFTWARE.
 
 #include "packet.h"
 
+#include <cstring>
+
+namespace {
+
+//! Size of the fixed part of RTP header
+const std::size_t kFixedHeaderSize = 12;
+//! Size of the extension header without content
+const std::size_t kExtensionHeaderSize = 4;
+
+} // namespace
+
 namespace rtp {
 
-Bytes Packet::Serialize() const {
-  Bytes bytes;
-
-  bytes.push_back((header.version << 6) | (header.padding << 5) |
-                  (header.extension << 4 ) | header.csrc_count);
-  bytes.push_back((header.marker << 7) | header.payload_type);
-  Bytes serialized_tmp = Serialize16(header.sequence_number);
-  bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-  serialized_tmp = Serialize32(header.timestamp);
-  bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-  serialized_tmp = Serialize32(header.synchronization_source);
-  bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-  if (header.csrc_count > 0) {
-    for (auto it = header.contributing_sources.begin();
-         it != header.contributing_sources.end();
-         ++it) {
-      serialized_tmp = Serialize32(*it);
-      bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-    }
+std::size_t Header::GetSerializedSize() const {
+  std::size_t size = kFixedHeaderSize + csrc_count * sizeof(uint32_t);
+  if (extension == 1) {
+    size += kExtensionHeaderSize + extension_header.content.size();
+  }
+
+  return size;
+}
+
+std::size_t Header::SerializeInto(Span<Byte> buffer) const {
+  const std::size_t size = GetSerializedSize();
+  CheckBufferSize(buffer, size);
+
+  Byte *dst = buffer.data();
+  *dst++ = (version << 6) | (padding << 5) | (extension << 4) | csrc_count;
+  *dst++ = (marker << 7) | payload_type;
+  dst = Write16(dst, sequence_number);
+  dst = Write32(dst, timestamp);
+  dst = Write32(dst, synchronization_source);
+  for (unsigned int i = 0; i < csrc_count; ++i) {
+    dst = Write32(dst, contributing_sources[i]);
   }
-  if (header.extension == 1) {
-    serialized_tmp = Serialize16(header.extension_header.id);
-    bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-    serialized_tmp = Serialize16(header.extension_header.length);
-    bytes.insert(bytes.end(), serialized_tmp.begin(), serialized_tmp.end());
-    bytes.insert(bytes.end(), header.extension_header.content.begin(),
-                 header.extension_header.content.begin());
+  if (extension == 1) {
+    dst = Write16(dst, extension_header.id);
+    dst = Write16(dst, extension_header.length);
+    std::memcpy(dst, extension_header.content.data(),
+                extension_header.content.size());
   }
 
-  bytes.insert(bytes.end(), payload.begin(), payload.end());
+  return size;
+}
+
+std::size_t Packet::GetSerializedSize() const {
+  return header.GetSerializedSize() + payload.size();
+}
+
+std::size_t Packet::SerializeInto(Span<Byte> buffer) const {
+  CheckBufferSize(buffer, GetSerializedSize());
+
+  const std::size_t header_size = header.SerializeInto(buffer);
+  std::memcpy(buffer.data() + header_size, payload.data(), payload.size());
+
+  return header_size + payload.size();
+}
+
+void PatchHeader(Span<Byte> header, const uint16_t sequence_number,
+                 const uint32_t timestamp, const uint32_t synchronization_source) {
+  CheckBufferSize(header, kFixedHeaderSize);
 
-  return bytes;
+  Byte *dst = header.data() + 2;
+  dst = Write16(dst, sequence_number);
+  dst = Write32(dst, timestamp);
+  Write32(dst, synchronization_source);
 }
 
 } // namespace rtp
@@ -25,6 +25,7 @@ SOFTWARE.
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 #include <array>
 #include <ostream>
@@ -36,7 +37,7 @@ namespace rtp {
 /**
  * @brief An RTP header
  */
-struct Header {
+struct Header : Serializable {
   //! Max number of contributing sources
   static const std::size_t kContributingSourcesMaxCount = 15;
 
@@ -58,6 +59,10 @@ struct Header {
     uint16_t length; //!< Length of the extension header. Equals to content.size()
     Bytes content; //!< The actual header represented in bytes
   } extension_header; //!< Extension header. Used then extension bit is set
+
+  std::size_t GetSerializedSize() const override;
+
+  std::size_t SerializeInto(Span<Byte> buffer) const override;
 };
 
 /**
@@ -67,9 +72,23 @@ struct Packet : Serializable {
   Header header;
   Bytes payload;
 
-  Bytes Serialize() const override;
+  std::size_t GetSerializedSize() const override;
+
+  std::size_t SerializeInto(Span<Byte> buffer) const override;
 };
 
 std::ostream &operator<<(std::ostream &os, const Packet &packet);
 
+/**
+ * @brief Overwrite stream-specific fields of serialized RTP header
+ * @details Lets packets serialized once be sent in several streams
+ *
+ * @param header Serialized RTP header
+ * @param sequence_number New sequence number
+ * @param timestamp New timestamp
+ * @param synchronization_source New SSRC
+ */
+void PatchHeader(Span<Byte> header, uint16_t sequence_number, uint32_t timestamp,
+                 uint32_t synchronization_source);
+
 } // namespace rtp
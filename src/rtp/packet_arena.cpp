@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "packet_arena.h"
+
+namespace rtp {
+
+PacketArena::PacketArena(const std::size_t max_packet_size) :
+max_packet_size_(max_packet_size),
+storage_(),
+sizes_() {}
+
+Span<Byte> PacketArena::Allocate() {
+  const std::size_t offset = sizes_.size() * max_packet_size_;
+  if (storage_.size() < offset + max_packet_size_) {
+    storage_.resize(offset + max_packet_size_);
+  }
+
+  return {storage_.data() + offset, max_packet_size_};
+}
+
+void PacketArena::Commit(const std::size_t size) {
+  sizes_.push_back(size);
+}
+
+void PacketArena::Clear() {
+  sizes_.clear();
+}
+
+std::size_t PacketArena::GetPacketsCount() const {
+  return sizes_.size();
+}
+
+Span<const Byte> PacketArena::GetPacket(const std::size_t index) const {
+  return {storage_.data() + index * max_packet_size_, sizes_[index]};
+}
+
+std::size_t PacketArena::GetMaxPacketSize() const {
+  return max_packet_size_;
+}
+
+} // namespace rtp
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <vector>
+
+#include "byte.h"
+#include "span.h"
+
+namespace rtp {
+
+/**
+ * @brief Reusable storage for the datagrams of one frame
+ * @details Packets are placed in fixed-size slots of one buffer. The buffer
+ * only grows, so after the largest frame is seen no more allocations happen
+ */
+class PacketArena {
+ public:
+  /**
+   * @brief Construct a new PacketArena object
+   *
+   * @param max_packet_size Size of one slot
+   */
+  explicit PacketArena(std::size_t max_packet_size);
+
+  /**
+   * @brief Get slot for the next packet
+   * @details Invalidates spans returned by previous calls and by GetPacket()
+   *
+   * @return Slot of GetMaxPacketSize() bytes
+   */
+  Span<Byte> Allocate();
+
+  /**
+   * @brief Finish the packet in the last allocated slot
+   *
+   * @param size Actual packet size
+   */
+  void Commit(std::size_t size);
+
+  /**
+   * @brief Remove all packets keeping memory for reuse
+   */
+  void Clear();
+
+  std::size_t GetPacketsCount() const;
+
+  /**
+   * @brief Get committed packet
+   *
+   * @param index Packet index
+   * @return Packet bytes
+   */
+  Span<const Byte> GetPacket(std::size_t index) const;
+
+  std::size_t GetMaxPacketSize() const;
+
+ private:
+  std::size_t max_packet_size_; //!< Size of one slot
+  Bytes storage_; //!< Slots of packets
+  std::vector<std::size_t> sizes_; //!< Sizes of committed packets
+};
+
+} // namespace rtp
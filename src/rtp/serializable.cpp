@@ -24,48 +24,21 @@ SOFTWARE.
 
 #include "serializable.h"
 
-namespace {
-
-const uint32_t kFirstOctetMask = 0xFF;
-const uint32_t kSecondOctetMask = 0xFF00;
-const uint32_t kThirdOctetMask = 0xFF0000;
-const uint32_t kFourthOctetMask = 0xFF000000;
-
-} // namespace
+#include <stdexcept>
 
 namespace rtp {
 
-Bytes Serialize16(uint16_t value) {
-  Bytes bytes;
-  bytes.reserve(2);
-
-  bytes.push_back((value & kSecondOctetMask) >> 8);
-  bytes.push_back(value & kFirstOctetMask);
+Bytes Serializable::Serialize() const {
+  Bytes bytes(GetSerializedSize());
+  SerializeInto(bytes);
 
   return bytes;
 }
 
-Bytes Serialize24(const unsigned int value) {
-  Bytes bytes;
-  bytes.reserve(3);
-
-  bytes.push_back((value & kThirdOctetMask) >> 16);
-  bytes.push_back((value & kSecondOctetMask) >> 8);
-  bytes.push_back(value & kFirstOctetMask);
-
-  return bytes;
-}
-
-Bytes Serialize32(const uint32_t value) {
-  Bytes bytes;
-  bytes.reserve(4);
-
-  bytes.push_back((value & kFourthOctetMask) >> 24);
-  bytes.push_back((value & kThirdOctetMask) >> 16);
-  bytes.push_back((value & kSecondOctetMask) >> 8);
-  bytes.push_back(value & kFirstOctetMask);
-
-  return bytes;
+void CheckBufferSize(Span<Byte> buffer, const std::size_t size) {
+  if (buffer.size() < size) {
+    throw std::length_error("Buffer is too small for serialized object");
+  }
 }
 
-} // namespace rtp
\ No newline at end of file
+} // namespace rtp
@@ -24,7 +24,11 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+#include <cstddef>
+
 #include "byte.h"
+#include "span.h"
 
 namespace rtp {
 
@@ -33,17 +37,67 @@ namespace rtp {
  */
 class Serializable {
  public:
-  virtual Bytes Serialize() const = 0;
+  virtual ~Serializable() = default;
+
+  /**
+   * @brief Get number of bytes SerializeInto() will write
+   *
+   * @return Size of serialized object
+   */
+  virtual std::size_t GetSerializedSize() const = 0;
+
+  /**
+   * @brief Serialize object into the caller buffer without allocations
+   * @throws std::length_error if buffer is smaller than GetSerializedSize()
+   *
+   * @param buffer Destination buffer
+   * @return Number of written bytes
+   */
+  virtual std::size_t SerializeInto(Span<Byte> buffer) const = 0;
+
+  /**
+   * @brief Serialize object into new bytes collection
+   *
+   * @return Serialized object
+   */
+  Bytes Serialize() const;
 };
 
 /**
- * @brief Serialize functions for integers of different length
+ * @brief Write functions for integers of different length in network byte order
  *
+ * @param dst Destination with enough space
  * @param value Unsigned integer
- * @return Bytes collection, representing given number
+ * @return Pointer past the last written byte
+ */
+constexpr Byte *Write16(Byte *dst, const uint16_t value) {
+  dst[0] = static_cast<Byte>(value >> 8);
+  dst[1] = static_cast<Byte>(value);
+  return dst + 2;
+}
+
+constexpr Byte *Write24(Byte *dst, const uint32_t value) {
+  dst[0] = static_cast<Byte>(value >> 16);
+  dst[1] = static_cast<Byte>(value >> 8);
+  dst[2] = static_cast<Byte>(value);
+  return dst + 3;
+}
+
+constexpr Byte *Write32(Byte *dst, const uint32_t value) {
+  dst[0] = static_cast<Byte>(value >> 24);
+  dst[1] = static_cast<Byte>(value >> 16);
+  dst[2] = static_cast<Byte>(value >> 8);
+  dst[3] = static_cast<Byte>(value);
+  return dst + 4;
+}
+
+/**
+ * @brief Check that buffer can fit serialized object
+ * @throws std::length_error if it can't
+ *
+ * @param buffer Destination buffer
+ * @param size Size of serialized object
  */
-Bytes Serialize16(uint16_t value);
-Bytes Serialize24(unsigned int value);
-Bytes Serialize32(uint32_t value);
+void CheckBufferSize(Span<Byte> buffer, std::size_t size);
 
 } // namespace rtp
@@ -0,0 +1,212 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "headers.h"
+
+#include <iterator>
+
+namespace {
+
+//! Names of the well-known headers in order of rtsp::HeaderId values
+constexpr std::string_view kHeaderNames[] = {
+  "Accept",
+  "Blocksize",
+  "Content-Base",
+  "Content-Length",
+  "Content-Type",
+  "CSeq",
+  "Date",
+  "Pipelined-Requests",
+  "Public",
+  "Range",
+  "Require",
+  "RTP-Info",
+  "Server",
+  "Session",
+  "Transport",
+  "Unsupported",
+  "User-Agent"
+};
+
+static_assert(std::size(kHeaderNames) ==
+              static_cast<std::size_t>(rtsp::HeaderId::kOther));
+
+/**
+ * @brief Transform ASCII letter to lower case
+ *
+ * @param c Character to transform
+ * @return Lower case letter or c if it's not an upper case letter
+ */
+constexpr char ToLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+} // namespace
+
+namespace rtsp {
+
+bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (ToLower(lhs[i]) != ToLower(rhs[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+HeaderId LookupHeaderId(std::string_view name) {
+  if (name.empty()) {
+    return HeaderId::kOther;
+  }
+
+  // Cheap checks of size and first letter reject almost all mismatches
+  const char first = ToLower(name.front());
+  for (std::size_t i = 0; i < std::size(kHeaderNames); ++i) {
+    const std::string_view known_name = kHeaderNames[i];
+    if (known_name.size() == name.size() && ToLower(known_name.front()) == first &&
+        EqualsIgnoreCase(known_name, name)) {
+      return static_cast<HeaderId>(i);
+    }
+  }
+
+  return HeaderId::kOther;
+}
+
+std::string_view HeaderIdToName(HeaderId id) {
+  const auto index = static_cast<std::size_t>(id);
+  return (index < std::size(kHeaderNames) ? kHeaderNames[index] : "");
+}
+
+Headers::Header::Header(HeaderId id, std::string_view name, std::string value) :
+id_(id),
+name_(id == HeaderId::kOther ? name : std::string_view()),
+value_(std::move(value)) {}
+
+HeaderId Headers::Header::GetId() const {
+  return id_;
+}
+
+std::string_view Headers::Header::GetName() const {
+  return (id_ == HeaderId::kOther ? std::string_view(name_) : HeaderIdToName(id_));
+}
+
+const std::string &Headers::Header::GetValue() const {
+  return value_;
+}
+
+std::string &Headers::Header::GetValue() {
+  return value_;
+}
+
+Headers::Headers(
+    std::initializer_list<std::pair<std::string_view, std::string>> headers) :
+headers_() {
+  headers_.reserve(headers.size());
+  for (const auto &[name, value] : headers) {
+    (*this)[name] = value;
+  }
+}
+
+const std::string *Headers::Find(HeaderId id) const {
+  const std::optional<std::size_t> index = FindIndex(id, std::string_view());
+  return (index.has_value() ? &headers_[index.value()].GetValue() : nullptr);
+}
+
+const std::string *Headers::Find(std::string_view name) const {
+  const std::optional<std::size_t> index = FindIndex(LookupHeaderId(name), name);
+  return (index.has_value() ? &headers_[index.value()].GetValue() : nullptr);
+}
+
+bool Headers::Contains(HeaderId id) const {
+  return (Find(id) != nullptr);
+}
+
+std::string &Headers::operator[](HeaderId id) {
+  return FindOrInsert(id, std::string_view());
+}
+
+std::string &Headers::operator[](std::string_view name) {
+  return FindOrInsert(LookupHeaderId(name), name);
+}
+
+void Headers::Merge(const Headers &other) {
+  for (const Header &header : other.headers_) {
+    if (!FindIndex(header.GetId(), header.GetName()).has_value()) {
+      headers_.push_back(header);
+    }
+  }
+}
+
+std::size_t Headers::Size() const {
+  return headers_.size();
+}
+
+bool Headers::Empty() const {
+  return headers_.empty();
+}
+
+Headers::ConstIterator Headers::begin() const {
+  return headers_.begin();
+}
+
+Headers::ConstIterator Headers::end() const {
+  return headers_.end();
+}
+
+std::optional<std::size_t> Headers::FindIndex(HeaderId id,
+                                              std::string_view name) const {
+  for (std::size_t i = 0; i < headers_.size(); ++i) {
+    const Header &header = headers_[i];
+    if (header.GetId() == id &&
+        (id != HeaderId::kOther || EqualsIgnoreCase(header.GetName(), name))) {
+      return i;
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::string &Headers::FindOrInsert(HeaderId id, std::string_view name) {
+  const std::optional<std::size_t> index = FindIndex(id, name);
+  if (index.has_value()) {
+    return headers_[index.value()].GetValue();
+  }
+
+  return headers_.emplace_back(id, name, std::string()).GetValue();
+}
+
+std::ostream &operator<<(std::ostream &os, const Headers &headers) {
+  for (const Headers::Header &header : headers) {
+    os << header.GetName() << ": " << header.GetValue() << "\r\n";
+  }
+
+  return os;
+}
+
+} // namespace rtsp
@@ -0,0 +1,209 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <initializer_list>
+#include <ostream>
+
+namespace rtsp {
+
+/**
+ * @brief Interned ids of the well-known headers
+ */
+enum class HeaderId : uint8_t {
+  kAccept,
+  kBlocksize,
+  kContentBase,
+  kContentLength,
+  kContentType,
+  kCSeq,
+  kDate,
+  kPipelinedRequests,
+  kPublic,
+  kRange,
+  kRequire,
+  kRtpInfo,
+  kServer,
+  kSession,
+  kTransport,
+  kUnsupported,
+  kUserAgent,
+  kOther //!< Any header, which is not listed above
+};
+
+/**
+ * @brief Compare strings ignoring case of ASCII letters
+ *
+ * @param lhs First string
+ * @param rhs Second string
+ * @return true If strings are equal
+ * @return false In other way
+ */
+bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs);
+
+/**
+ * @brief Find id of the header name, case-insensitive
+ *
+ * @param name Header name
+ * @return Id of the well-known header or HeaderId::kOther
+ */
+HeaderId LookupHeaderId(std::string_view name);
+
+/**
+ * @brief Get canonical name of the well-known header
+ *
+ * @param id Header id other than HeaderId::kOther
+ * @return Header name
+ */
+std::string_view HeaderIdToName(HeaderId id);
+
+/**
+ * @brief Case-insensitive header collection, which doesn't allocate on lookup
+ * @details Headers are kept in a small flat array in insertion order.
+ * Well-known headers are found by id, other ones by name
+ */
+class Headers {
+ public:
+  /**
+   * @brief Single header
+   */
+  class Header {
+   public:
+    Header(HeaderId id, std::string_view name, std::string value);
+
+    HeaderId GetId() const;
+
+    std::string_view GetName() const;
+
+    const std::string &GetValue() const;
+
+    std::string &GetValue();
+
+   private:
+    HeaderId id_; //!< Header id
+    std::string name_; //!< Header name. Empty for well-known headers
+    std::string value_; //!< Header value
+  };
+
+  using ConstIterator = std::vector<Header>::const_iterator;
+
+  Headers() = default;
+
+  /**
+   * @brief Construct a new Headers object
+   *
+   * @param headers Pairs of header name and value
+   */
+  Headers(std::initializer_list<std::pair<std::string_view, std::string>> headers);
+
+  /**
+   * @brief Find value of the header
+   *
+   * @param id Id of the well-known header
+   * @return Pointer to the value or nullptr if there is no such header
+   */
+  const std::string *Find(HeaderId id) const;
+
+  /**
+   * @brief Find value of the header
+   *
+   * @param name Header name, case-insensitive
+   * @return Pointer to the value or nullptr if there is no such header
+   */
+  const std::string *Find(std::string_view name) const;
+
+  /**
+   * @brief Check if header exists
+   *
+   * @param id Id of the well-known header
+   * @return true If header exists
+   * @return false In other way
+   */
+  bool Contains(HeaderId id) const;
+
+  /**
+   * @brief Get value of the header, inserting empty one if it doesn't exist
+   *
+   * @param id Id of the well-known header
+   * @return Reference to the value
+   */
+  std::string &operator[](HeaderId id);
+
+  /**
+   * @brief Get value of the header, inserting empty one if it doesn't exist
+   *
+   * @param name Header name, case-insensitive
+   * @return Reference to the value
+   */
+  std::string &operator[](std::string_view name);
+
+  /**
+   * @brief Add headers from other, which are not present in this object
+   *
+   * @param other Headers to add
+   */
+  void Merge(const Headers &other);
+
+  std::size_t Size() const;
+
+  bool Empty() const;
+
+  ConstIterator begin() const;
+
+  ConstIterator end() const;
+
+ private:
+  std::vector<Header> headers_; //!< Headers in insertion order
+
+  /**
+   * @brief Find header with the given id and name
+   *
+   * @param id Header id
+   * @param name Header name, used only if id is HeaderId::kOther
+   * @return Index of the header or std::nullopt
+   */
+  std::optional<std::size_t> FindIndex(HeaderId id, std::string_view name) const;
+
+  /**
+   * @brief Get value of the header, inserting empty one if it doesn't exist
+   *
+   * @param id Header id
+   * @param name Header name, used only if id is HeaderId::kOther
+   * @return Reference to the value
+   */
+  std::string &FindOrInsert(HeaderId id, std::string_view name);
+};
+
+std::ostream &operator<<(std::ostream &os, const Headers &headers);
+
+} // namespace rtsp
@@ -0,0 +1,51 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "interleaved.h"
+
+namespace rtsp {
+
+InterleavedHeader BuildInterleavedHeader(const uint8_t channel, const uint16_t size) {
+  return {static_cast<Byte>(kInterleavedMarker), channel,
+          static_cast<Byte>(size >> 8), static_cast<Byte>(size & 0xFF)};
+}
+
+std::size_t ParseInterleavedData(std::string_view buffer,
+                                 InterleavedData &interleaved) {
+  if (buffer.size() < kInterleavedHeaderSize) {
+    return 0;
+  }
+
+  const auto *bytes = reinterpret_cast<const Byte *>(buffer.data());
+  const std::size_t size = (static_cast<std::size_t>(bytes[2]) << 8) | bytes[3];
+  if (buffer.size() < kInterleavedHeaderSize + size) {
+    return 0;
+  }
+
+  interleaved.channel = bytes[1];
+  interleaved.data = Span<const Byte>(bytes + kInterleavedHeaderSize, size);
+  return kInterleavedHeaderSize + size;
+}
+
+} // namespace rtsp
@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <string_view>
+
+#include "byte.h"
+#include "span.h"
+
+namespace rtsp {
+
+//! First byte of binary data interleaved with RTSP messages
+constexpr char kInterleavedMarker = '$';
+//! Size of the interleaved data header: marker, channel and length
+constexpr std::size_t kInterleavedHeaderSize = 4;
+
+//! Header of interleaved data
+using InterleavedHeader = std::array<Byte, kInterleavedHeaderSize>;
+
+/**
+ * @brief Binary data interleaved with RTSP messages on the same connection
+ */
+struct InterleavedData {
+  uint8_t channel; //!< Channel number, negotiated with interleaved parameter
+  Span<const Byte> data; //!< Data of the message without header
+};
+
+/**
+ * @brief Build header of interleaved data
+ *
+ * @param channel Channel number
+ * @param size Size of the data
+ * @return Header to send before the data
+ */
+InterleavedHeader BuildInterleavedHeader(uint8_t channel, uint16_t size);
+
+/**
+ * @brief Parse interleaved data at the beginning of the buffer
+ * @details Buffer must start with kInterleavedMarker
+ *
+ * @param buffer Received data
+ * @param interleaved Parsed data pointing into the buffer. Filled only if
+ * data is complete
+ * @return Size of the data with header, if it is complete
+ * @return 0 if more data is needed
+ */
+std::size_t ParseInterleavedData(std::string_view buffer, InterleavedData &interleaved);
+
+} // namespace rtsp
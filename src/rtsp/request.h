@@ -25,11 +25,19 @@ SOFTWARE.
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <optional>
+#include <memory>
 #include <stdexcept>
 #include <ostream>
 
-#include "sock/socket.h"
+#include "headers.h"
+
+namespace sock {
+
+class SharedOutput;
+
+} // namespace sock
 
 namespace rtsp {
 
@@ -66,38 +74,27 @@ enum class Method {
 std::string MethodToString(Method method);
 
 /**
- * @brief Specific hasher for header names to provide case-insensitivity
- */
-struct HeaderNameHash {
-  std::size_t operator()(std::string header_name) const;
-};
-
-/**
- * @brief Specific equal for header names to provide case-insensitivity
+ * @brief Converts string to method
+ *
+ * @param method_str String with method name
+ * @return Method if name is known
  */
-struct HeaderNameEqual {
-  bool operator()(std::string lhs, std::string rhs) const;
-};
+std::optional<Method> StringToMethod(std::string_view method_str);
 
 /**
  * @brief Request from Client to Server
  */
 struct Request {
-  using Headers = std::unordered_map<std::string, std::string,
-                                     HeaderNameHash, HeaderNameEqual>;
-
   std::string client_ip;
   Method method;
   std::string url;
   float version;
   Headers headers;
   std::string body;
+  //! Output of the request connection for interleaved data
+  std::shared_ptr<sock::SharedOutput> connection_output;
 };
 
-std::ostream &operator<<(std::ostream &os, const Request::Headers &headers);
-
 std::ostream &operator<<(std::ostream &os, const Request &request);
 
-sock::Socket &operator>>(sock::Socket &socket, Request &request);
-
 } // namespace rtsp
@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "request_parser.h"
+
+#include <cctype>
+#include <cstring>
+
+#include <charconv>
+#include <string>
+
+namespace {
+
+//! Max size of the request line and headers including empty lines before
+const std::size_t kMaxHeaderSize = 16 * 1024;
+//! Max number of headers in one request
+const std::size_t kMaxHeadersCount = 64;
+//! Max size of the request body
+const std::size_t kMaxBodySize = 1024 * 1024;
+
+/**
+ * @brief Check if character is space or horizontal tab
+ *
+ * @param c Character to check
+ * @return true If c is whitespace
+ * @return false In other way
+ */
+bool IsWhitespace(char c) {
+  return (c == ' ' || c == '\t');
+}
+
+} // namespace
+
+namespace rtsp {
+
+RequestParser::RequestParser() :
+state_(State::kRequestLine),
+position_(0),
+line_start_(0),
+method_(Method::kOptions),
+url_{0, 0},
+version_(0),
+headers_(),
+body_offset_(0),
+content_length_(0) {}
+
+std::size_t RequestParser::Parse(std::string_view buffer, RequestView &request) {
+  try {
+    while (state_ != State::kBody) {
+      const void *line_end_ptr = std::memchr(buffer.data() + position_, '\n',
+                                             buffer.size() - position_);
+      if (line_end_ptr == nullptr) {
+        position_ = buffer.size();
+        if (position_ > kMaxHeaderSize) {
+          throw ParseError("Request header is too large");
+        }
+        return 0;
+      }
+
+      // Buffer starts with the request, so complete lines are limited too
+      const std::size_t line_end = static_cast<const char *>(line_end_ptr) -
+          buffer.data();
+      if (line_end >= kMaxHeaderSize) {
+        throw ParseError("Request header is too large");
+      }
+      Slice line{line_start_, line_end - line_start_};
+      if (line.size > 0 && buffer[line_end - 1] == '\r') {
+        --line.size;
+      }
+      position_ = line_start_ = line_end + 1;
+
+      if (state_ == State::kRequestLine) {
+        // Empty lines before request are allowed
+        if (line.size > 0) {
+          ParseRequestLine(buffer, line);
+          state_ = State::kHeaders;
+        }
+      } else if (line.size > 0) {
+        ParseHeaderLine(buffer, line);
+      } else {
+        body_offset_ = position_;
+        state_ = State::kBody;
+      }
+    }
+  } catch (const ParseError &) {
+    Reset();
+    throw;
+  }
+
+  const std::size_t request_size = body_offset_ + content_length_;
+  if (buffer.size() < request_size) {
+    return 0;
+  }
+
+  request.method = method_;
+  request.url = buffer.substr(url_.offset, url_.size);
+  request.version = version_;
+  request.headers.clear();
+  for (const auto &[name, value] : headers_) {
+    request.headers.emplace_back(buffer.substr(name.offset, name.size),
+                                 buffer.substr(value.offset, value.size));
+  }
+  request.body = buffer.substr(body_offset_, content_length_);
+
+  Reset();
+  return request_size;
+}
+
+void RequestParser::Reset() {
+  state_ = State::kRequestLine;
+  position_ = 0;
+  line_start_ = 0;
+  headers_.clear();
+  body_offset_ = 0;
+  content_length_ = 0;
+}
+
+void RequestParser::ParseRequestLine(std::string_view buffer, Slice line) {
+  const std::string_view line_view = buffer.substr(line.offset, line.size);
+
+  const std::size_t method_end = line_view.find(' ');
+  const std::size_t url_end = line_view.find(' ', method_end + 1);
+  if (method_end == std::string_view::npos || url_end == std::string_view::npos) {
+    throw ParseError("Malformed request line");
+  }
+
+  const std::string_view method_str = line_view.substr(0, method_end);
+  const std::optional<Method> method = StringToMethod(method_str);
+  if (!method.has_value()) {
+    throw ParseError("Unknown method " + std::string(method_str));
+  }
+  method_ = method.value();
+
+  url_ = {line.offset + method_end + 1, url_end - method_end - 1};
+
+  const std::string_view kProtocol = "RTSP/";
+  const std::string_view version_str = line_view.substr(url_end + 1);
+  if (version_str.substr(0, kProtocol.size()) != kProtocol) {
+    throw ParseError("Expected RTSP protocol, but got " + std::string(version_str));
+  }
+
+  // Version has always form of DIGIT.DIGIT
+  const std::string_view digits = version_str.substr(kProtocol.size());
+  if (digits.size() != 3 || !std::isdigit(static_cast<unsigned char>(digits[0])) ||
+      digits[1] != '.' || !std::isdigit(static_cast<unsigned char>(digits[2]))) {
+    throw ParseError("Malformed version " + std::string(version_str));
+  }
+  version_ = static_cast<float>(digits[0] - '0') +
+      static_cast<float>(digits[2] - '0') / 10;
+}
+
+void RequestParser::ParseHeaderLine(std::string_view buffer, Slice line) {
+  const std::string_view line_view = buffer.substr(line.offset, line.size);
+
+  const std::size_t colon_pos = line_view.find(':');
+  if (colon_pos == std::string_view::npos || colon_pos == 0) {
+    throw ParseError("Malformed header " + std::string(line_view));
+  }
+
+  std::size_t value_start = colon_pos + 1;
+  while (value_start < line_view.size() && IsWhitespace(line_view[value_start])) {
+    ++value_start;
+  }
+  std::size_t value_end = line_view.size();
+  while (value_end > value_start && IsWhitespace(line_view[value_end - 1])) {
+    --value_end;
+  }
+
+  if (headers_.size() == kMaxHeadersCount) {
+    throw ParseError("Too many headers");
+  }
+
+  const Slice name{line.offset, colon_pos};
+  const Slice value{line.offset + value_start, value_end - value_start};
+  headers_.emplace_back(name, value);
+
+  if (LookupHeaderId(line_view.substr(0, colon_pos)) == HeaderId::kContentLength) {
+    const char *value_begin = line_view.data() + value_start;
+    const char *value_last = line_view.data() + value_end;
+    const auto [ptr, ec] = std::from_chars(value_begin, value_last, content_length_);
+    if (ec != std::errc() || ptr != value_last || content_length_ > kMaxBodySize) {
+      throw ParseError("Invalid Content-Length");
+    }
+  }
+}
+
+Request ToRequest(const RequestView &view) {
+  Request request;
+  request.method = view.method;
+  request.url = view.url;
+  request.version = view.version;
+  for (const auto &[name, value] : view.headers) {
+    request.headers[name] = value;
+  }
+  request.body = view.body;
+
+  return request;
+}
+
+} // namespace rtsp
@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <string_view>
+#include <vector>
+#include <utility>
+
+#include "request.h"
+
+namespace rtsp {
+
+/**
+ * @brief Request, which fields point into the buffer it was parsed from
+ * @details Valid only while that buffer is not modified
+ */
+struct RequestView {
+  using Header = std::pair<std::string_view, std::string_view>;
+
+  Method method;
+  std::string_view url;
+  float version;
+  std::vector<Header> headers;
+  std::string_view body;
+};
+
+/**
+ * @brief Resumable parser of RTSP requests
+ * @details Parser remembers how far it has scanned the buffer, so every byte
+ * of the request is examined only once no matter how many parts the request
+ * arrives in. Parsed fields refer to the buffer without copying
+ */
+class RequestParser {
+ public:
+  RequestParser();
+
+  /**
+   * @brief Continue parsing of the request at the beginning of the buffer
+   * @details Buffer should contain the same beginning as on previous calls,
+   * possibly with more data appended. Buffer may be reallocated between calls.
+   * After complete request is parsed, parser is ready for the next one
+   * @throws rtsp::ParseError if request is malformed. Parser is reset then
+   *
+   * @param buffer Received data
+   * @param request Parsed request. Filled only if request is complete
+   * @return Size of the parsed request, if it is complete
+   * @return 0 if more data is needed
+   */
+  std::size_t Parse(std::string_view buffer, RequestView &request);
+
+  /**
+   * @brief Forget about partially parsed request
+   */
+  void Reset();
+
+ private:
+  /**
+   * @brief Part of the request, which parser is waiting for
+   */
+  enum class State {
+    kRequestLine,
+    kHeaders,
+    kBody
+  };
+
+  /**
+   * @brief Position of the substring in the buffer
+   */
+  struct Slice {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  State state_; //!< Current state
+  std::size_t position_; //!< Offset of the first not yet scanned byte
+  std::size_t line_start_; //!< Offset of the current line
+  Method method_; //!< Parsed method
+  Slice url_; //!< Parsed url
+  float version_; //!< Parsed version
+  std::vector<std::pair<Slice, Slice>> headers_; //!< Parsed headers
+  std::size_t body_offset_; //!< Offset of the body
+  std::size_t content_length_; //!< Expected size of the body
+
+  /**
+   * @brief Parse request line
+   * @throws rtsp::ParseError if line is malformed
+   *
+   * @param buffer Received data
+   * @param line Line without line break
+   */
+  void ParseRequestLine(std::string_view buffer, Slice line);
+
+  /**
+   * @brief Parse header line
+   * @throws rtsp::ParseError if line is malformed
+   *
+   * @param buffer Received data
+   * @param line Line without line break
+   */
+  void ParseHeaderLine(std::string_view buffer, Slice line);
+};
+
+/**
+ * @brief Make request owning its data
+ *
+ * @param view Parsed request
+ * @return Request with copied data
+ */
+Request ToRequest(const RequestView &view);
+
+} // namespace rtsp
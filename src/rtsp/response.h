@@ -25,10 +25,9 @@ SOFTWARE.
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <ostream>
 
-#include "request.h"
+#include "headers.h"
 
 namespace rtsp {
 
@@ -36,8 +35,6 @@ namespace rtsp {
  * @brief Response from Server to Client
  */
 struct Response {
-  using Headers = Request::Headers;
-
   Response();
 
   Response(int code, std::string description,
@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "response_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief Pre-serialized status line
+ */
+struct StatusLineTemplate {
+  int code;
+  std::string_view description;
+  std::string_view line;
+};
+
+//! Status lines of RTSP/1.0 responses sent by the server
+constexpr StatusLineTemplate kStatusLines[] = {
+  {200, "OK", "RTSP/1.0 200 OK\r\n"},
+  {400, "Bad Request", "RTSP/1.0 400 Bad Request\r\n"},
+  {404, "Not Found", "RTSP/1.0 404 Not Found\r\n"},
+  {405, "Method Not Allowed", "RTSP/1.0 405 Method Not Allowed\r\n"},
+  {454, "Session Not Found", "RTSP/1.0 454 Session Not Found\r\n"},
+  {455, "Method Not Valid in This State",
+   "RTSP/1.0 455 Method Not Valid in This State\r\n"},
+  {459, "Aggregate Operation Not Allowed",
+   "RTSP/1.0 459 Aggregate Operation Not Allowed\r\n"},
+  {461, "Unsupported Transport", "RTSP/1.0 461 Unsupported Transport\r\n"},
+  {500, "Internal Server Error", "RTSP/1.0 500 Internal Server Error\r\n"},
+  {501, "Not Implemented", "RTSP/1.0 501 Not Implemented\r\n"},
+  {505, "RTSP Version not supported",
+   "RTSP/1.0 505 RTSP Version not supported\r\n"}
+};
+
+/**
+ * @brief Append integer to the buffer
+ *
+ * @param value Integer to append
+ * @param buffer Output buffer
+ */
+void AppendInt(int value, std::string &buffer) {
+  char digits[16];
+  const auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), value);
+  buffer.append(digits, end);
+}
+
+/**
+ * @brief Append status line of the response to the buffer
+ *
+ * @param response Response
+ * @param buffer Output buffer
+ */
+void WriteStatusLine(const rtsp::Response &response, std::string &buffer) {
+  if (response.version == 1.0f) {
+    for (const StatusLineTemplate &status_line : kStatusLines) {
+      if (status_line.code == response.code &&
+          status_line.description == response.description) {
+        buffer.append(status_line.line);
+        return;
+      }
+    }
+  }
+
+  // Version has always form of DIGIT.DIGIT
+  const int version = static_cast<int>(std::lround(response.version * 10));
+  buffer.append("RTSP/");
+  buffer.push_back(static_cast<char>('0' + version / 10 % 10));
+  buffer.push_back('.');
+  buffer.push_back(static_cast<char>('0' + version % 10));
+  buffer.push_back(' ');
+  AppendInt(response.code, buffer);
+  buffer.push_back(' ');
+  buffer.append(response.description);
+  buffer.append("\r\n");
+}
+
+} // namespace
+
+namespace rtsp {
+
+void WriteResponseHead(const Response &response, std::string &buffer) {
+  WriteStatusLine(response, buffer);
+
+  for (const Headers::Header &header : response.headers) {
+    buffer.append(header.GetName());
+    buffer.append(": ");
+    buffer.append(header.GetValue());
+    buffer.append("\r\n");
+  }
+
+  buffer.append("\r\n");
+}
+
+} // namespace rtsp
@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "url.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Check if string contains whitespaces or control characters
+ *
+ * @param str String to check
+ * @return true If there is at least one such character
+ * @return false In other way
+ */
+bool HasSpaces(std::string_view str) {
+  return std::any_of(str.begin(), str.end(), [](char c) {
+    return (static_cast<unsigned char>(c) <= ' ');
+  });
+}
+
+} // namespace
+
+namespace rtsp {
+
+std::optional<Url> SplitUrl(std::string_view url) {
+  if (HasSpaces(url)) {
+    return std::nullopt;
+  }
+
+  Url result;
+
+  const std::string_view kSchemeDelimiter = "://";
+  const std::size_t scheme_end = url.find(kSchemeDelimiter);
+  if (scheme_end == std::string_view::npos || scheme_end == 0) {
+    return std::nullopt;
+  }
+  result.scheme = url.substr(0, scheme_end);
+  url.remove_prefix(scheme_end + kSchemeDelimiter.size());
+
+  const std::size_t path_start = std::min(url.find('/'), url.size());
+  std::string_view authority = url.substr(0, path_start);
+  result.path = url.substr(path_start);
+  while (!result.path.empty() && result.path.back() == '/') {
+    result.path.remove_suffix(1);
+  }
+
+  const std::size_t at_pos = authority.rfind('@');
+  if (at_pos != std::string_view::npos) {
+    const std::string_view user_info = authority.substr(0, at_pos);
+    const std::size_t colon_pos = user_info.find(':');
+    result.user = user_info.substr(0, colon_pos);
+    if (colon_pos != std::string_view::npos) {
+      result.password = user_info.substr(colon_pos + 1);
+    }
+    authority.remove_prefix(at_pos + 1);
+  }
+
+  const std::size_t port_start = authority.find(':');
+  result.host = authority.substr(0, port_start);
+  if (port_start != std::string_view::npos) {
+    result.port = authority.substr(port_start + 1);
+    if (result.port.empty() ||
+        !std::all_of(result.port.begin(), result.port.end(), [](char c) {
+          return (c >= '0' && c <= '9');
+        })) {
+      return std::nullopt;
+    }
+  }
+
+  if (result.host.empty()) {
+    return std::nullopt;
+  }
+
+  return result;
+}
+
+} // namespace rtsp
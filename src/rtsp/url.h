@@ -0,0 +1,52 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <string_view>
+#include <optional>
+
+namespace rtsp {
+
+/**
+ * @brief Components of the url. All of them point into the original string
+ */
+struct Url {
+  std::string_view scheme;
+  std::string_view user;
+  std::string_view password;
+  std::string_view host;
+  std::string_view port;
+  std::string_view path; //!< Path without trailing slash. Empty for root
+};
+
+/**
+ * @brief Split url like scheme://[user[:password]@]host[:port][/path]
+ *
+ * @param url Full url
+ * @return Url components if url is well-formed
+ */
+std::optional<Url> SplitUrl(std::string_view url);
+
+} // namespace rtsp
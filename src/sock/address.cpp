@@ -0,0 +1,50 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "address.h"
+
+#include <arpa/inet.h>
+
+#include <stdexcept>
+
+namespace sock {
+
+Address::Address(const std::string &ip, const int port) :
+address_() {
+  address_.sin_family = AF_INET;
+  address_.sin_port = htons(port);
+  if (inet_pton(AF_INET, ip.c_str(), &address_.sin_addr) != 1) {
+    throw std::invalid_argument("Invalid ip address");
+  }
+}
+
+const sockaddr *Address::GetSockaddr() const {
+  return reinterpret_cast<const sockaddr *>(&address_);
+}
+
+socklen_t Address::GetSize() const {
+  return sizeof(address_);
+}
+
+} // namespace sock
@@ -24,9 +24,15 @@ SOFTWARE.
 
 #include "client_socket.h"
 
+#include <cstring>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include <string>
+
+#include "exception.h"
+
 namespace sock {
 
 ClientSocket::ClientSocket(Type type) :
@@ -34,6 +40,18 @@ Socket(type) {
 
 }
 
+void ClientSocket::Bind(const int port) {
+  sockaddr_in local_addr = {};
+  local_addr.sin_family = AF_INET;
+  local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  local_addr.sin_port = htons(port);
+
+  if (bind(descriptor_, reinterpret_cast<sockaddr *>(&local_addr),
+           sizeof(local_addr)) < 0) {
+    throw BindError(std::string("Can't bind socket: ") + strerror(errno));
+  }
+}
+
 bool ClientSocket::Connect(const std::string &ip, int port) {
   sockaddr_in server_addr;
   server_addr.sin_family = AF_INET;
@@ -48,4 +66,14 @@ bool ClientSocket::Connect(const std::string &ip, int port) {
   return (res == 0);
 }
 
+std::optional<int> ClientSocket::GetPathMtu() const {
+  int mtu = 0;
+  socklen_t size = sizeof(mtu);
+  if (getsockopt(descriptor_, IPPROTO_IP, IP_MTU, &mtu, &size) != 0) {
+    return std::nullopt;
+  }
+
+  return mtu;
+}
+
 } // namespace sock
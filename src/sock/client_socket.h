@@ -24,6 +24,8 @@ SOFTWARE.
 
 #pragma once
 
+#include <optional>
+
 #include "socket.h"
 
 namespace sock {
@@ -40,6 +42,14 @@ class ClientSocket : public Socket {
    */
   ClientSocket(Type type);
 
+  /**
+   * @brief Bind socket to the local port
+   * @throws BindError if port can't be bound
+   *
+   * @param port Local port
+   */
+  void Bind(int port);
+
   /**
    * @brief Connect to the server socket
    *
@@ -49,6 +59,14 @@ class ClientSocket : public Socket {
    * @return false In other way
    */
   bool Connect(const std::string &ip, int port);
+
+  /**
+   * @brief Get MTU of the path to the other side
+   * @details Socket must be connected
+   *
+   * @return MTU in bytes if it's known
+   */
+  std::optional<int> GetPathMtu() const;
 };
 
 } // namespace sock
@@ -0,0 +1,386 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "connection.h"
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+
+#include <iostream>
+#include <utility>
+#include <algorithm>
+
+#include "exception.h"
+
+namespace {
+
+//! Max number of bytes read in one ReadAvailable() call to be fair to other connections
+const std::size_t kMaxReadPerCall = 64 * 1024;
+//! Max number of queued pieces passed to one sendmsg() call
+const std::size_t kMaxChunksPerCall = 64;
+//! Max number of bytes queued in the shared output. Several frames of a stream
+const std::size_t kSharedOutputCapacity = 2 * 1024 * 1024;
+//! Max number of shared output pieces passed to one sendmsg() call
+const std::size_t kMaxPiecesPerCall = 256;
+//! Min size of the send, for which zero copy pays off its page pinning
+const std::size_t kMinZeroCopySize = 16 * 1024;
+
+} // namespace
+
+namespace sock {
+
+Connection::Connection(Socket socket, SharedOutput::Notifier notifier) :
+socket_(std::move(socket)),
+peer_name_(socket_.GetPeerName()),
+input_(),
+output_(),
+output_committed_(0),
+chunks_(),
+chunk_index_(0),
+chunk_offset_(0),
+closing_(false),
+shared_output_(std::make_shared<SharedOutput>(kSharedOutputCapacity,
+                                              std::move(notifier))),
+shared_batch_(),
+shared_piece_index_(0),
+shared_piece_offset_(0),
+shared_message_index_(0),
+shared_sent_(0),
+zero_copy_(false),
+batch_zero_copied_(false),
+next_zero_copy_send_(0),
+completed_zero_copy_sends_(0),
+completed_ranges_(),
+retired_batches_() {
+  const int descriptor = socket_.GetDescriptor();
+  if (fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL, 0) | O_NONBLOCK) < 0) {
+    throw SocketException("Can't set non blocking option for socket");
+  }
+}
+
+Connection::~Connection() {
+  shared_output_->Close();
+}
+
+int Connection::GetDescriptor() const {
+  return socket_.GetDescriptor();
+}
+
+const std::string &Connection::GetPeerName() const {
+  return peer_name_;
+}
+
+std::string &Connection::GetInput() {
+  return input_;
+}
+
+std::string &Connection::GetOutputBuffer() {
+  return output_;
+}
+
+void Connection::Write(std::string_view data) {
+  output_.append(data);
+}
+
+void Connection::Attach(std::string data) {
+  if (data.empty()) {
+    return;
+  }
+
+  CommitOutputBuffer();
+  const std::size_t size = data.size();
+  chunks_.push_back({0, size, std::move(data)});
+}
+
+bool Connection::EnableZeroCopy() {
+  zero_copy_ = socket_.EnableZeroCopy();
+  return zero_copy_;
+}
+
+const std::shared_ptr<SharedOutput> &Connection::GetSharedOutput() const {
+  return shared_output_;
+}
+
+void Connection::Close() {
+  closing_ = true;
+}
+
+bool Connection::IsClosing() const {
+  return closing_;
+}
+
+bool Connection::HasPendingOutput() const {
+  return (chunk_index_ < chunks_.size() || output_committed_ < output_.size() ||
+          shared_sent_ < shared_batch_.size);
+}
+
+bool Connection::HasPendingZeroCopy() const {
+  return completed_zero_copy_sends_ != next_zero_copy_send_;
+}
+
+void Connection::Shutdown() {
+  shared_output_->Close();
+  closing_ = true;
+  // Queued data is still delivered by kernel before FIN
+  shutdown(socket_.GetDescriptor(), SHUT_RDWR);
+}
+
+bool Connection::HandleErrorQueue() {
+  try {
+    while (std::optional<ZeroCopyCompletion> completion =
+               socket_.ReceiveZeroCopyCompletion()) {
+      CompleteZeroCopy(*completion);
+    }
+  } catch (const ReadError &) {
+    return false;
+  }
+
+  int error = 0;
+  socklen_t size = sizeof(error);
+  return (getsockopt(socket_.GetDescriptor(), SOL_SOCKET, SO_ERROR, &error, &size) == 0 &&
+          error == 0);
+}
+
+bool Connection::ReadAvailable() {
+  char buffer[4096];
+  std::size_t total = 0;
+
+  while (total < kMaxReadPerCall) {
+    const ssize_t res = recv(socket_.GetDescriptor(), buffer, sizeof(buffer), 0);
+    if (res > 0) {
+      input_.append(buffer, res);
+      total += res;
+      continue;
+    }
+
+    if (res == 0) {
+      return false;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+
+  return true;
+}
+
+bool Connection::Flush() {
+  // Stream framing breaks, if anything gets into the middle of a message
+  if (!FlushSharedData(true) || !FlushChunks()) {
+    return false;
+  }
+
+  // Responses go first, data waits for them
+  if (chunk_index_ < chunks_.size()) {
+    return true;
+  }
+  return FlushSharedData(false);
+}
+
+bool Connection::FlushChunks() {
+  CommitOutputBuffer();
+
+  while (chunk_index_ < chunks_.size()) {
+    iovec iov[kMaxChunksPerCall];
+    std::size_t iov_count = 0;
+    for (std::size_t i = chunk_index_;
+         i < chunks_.size() && iov_count < kMaxChunksPerCall; ++i) {
+      const std::size_t skip = (i == chunk_index_ ? chunk_offset_ : 0);
+      iov[iov_count].iov_base = const_cast<char *>(GetChunkData(chunks_[i]) + skip);
+      iov[iov_count].iov_len = chunks_[i].size - skip;
+      ++iov_count;
+    }
+
+    msghdr message = {};
+    message.msg_iov = iov;
+    message.msg_iovlen = iov_count;
+    ssize_t res = sendmsg(socket_.GetDescriptor(), &message, MSG_NOSIGNAL);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    while (res > 0) {
+      const std::size_t left = chunks_[chunk_index_].size - chunk_offset_;
+      if (static_cast<std::size_t>(res) < left) {
+        chunk_offset_ += res;
+        break;
+      }
+
+      res -= left;
+      ++chunk_index_;
+      chunk_offset_ = 0;
+    }
+  }
+
+  // Memory of the buffer is kept for the next responses
+  output_.clear();
+  output_committed_ = 0;
+  chunks_.clear();
+  chunk_index_ = 0;
+  return true;
+}
+
+void Connection::CommitOutputBuffer() {
+  if (output_committed_ == output_.size()) {
+    return;
+  }
+
+  const std::size_t size = output_.size() - output_committed_;
+  if (!chunks_.empty() && chunks_.back().data.empty() &&
+      chunks_.back().offset + chunks_.back().size == output_committed_) {
+    chunks_.back().size += size;
+  } else {
+    chunks_.push_back({output_committed_, size, std::string()});
+  }
+  output_committed_ = output_.size();
+}
+
+bool Connection::FlushSharedData(const bool current_message_only) {
+  // Set when kernel runs out of memory for pinned pages
+  bool copy_fallback = false;
+
+  for (;;) {
+    if (shared_sent_ == shared_batch_.size) {
+      if (current_message_only) {
+        return true;
+      }
+
+      // Kernel may still read data of zero-copy sends
+      if (batch_zero_copied_) {
+        retired_batches_.push_back({std::move(shared_batch_), next_zero_copy_send_});
+        shared_batch_ = SharedOutput::Batch();
+      }
+      // Memory of the batch is kept for the next messages
+      shared_batch_.Clear();
+      shared_piece_index_ = 0;
+      shared_piece_offset_ = 0;
+      shared_message_index_ = 0;
+      shared_sent_ = 0;
+      batch_zero_copied_ = false;
+      if (!shared_output_->Take(shared_batch_)) {
+        return true;
+      }
+    }
+
+    std::size_t end = shared_batch_.size;
+    if (current_message_only) {
+      const std::size_t message_begin = (shared_message_index_ == 0 ? 0 :
+          shared_batch_.message_ends[shared_message_index_ - 1]);
+      if (shared_sent_ == message_begin) {
+        return true;
+      }
+      end = shared_batch_.message_ends[shared_message_index_];
+    }
+
+    iovec iov[kMaxPiecesPerCall];
+    std::size_t iov_count = 0;
+    std::size_t size = 0;
+    for (std::size_t i = shared_piece_index_; i < shared_batch_.pieces.size() &&
+         iov_count < kMaxPiecesPerCall && shared_sent_ + size < end; ++i) {
+      const SharedOutput::Batch::Piece &piece = shared_batch_.pieces[i];
+      const std::size_t skip = (i == shared_piece_index_ ? shared_piece_offset_ : 0);
+      const std::size_t length = std::min(piece.size - skip, end - shared_sent_ - size);
+      iov[iov_count].iov_base = const_cast<Byte *>(shared_batch_.GetPieceData(piece) +
+                                                   skip);
+      iov[iov_count].iov_len = length;
+      size += length;
+      ++iov_count;
+    }
+
+    const bool zero_copy = (zero_copy_ && !copy_fallback && size >= kMinZeroCopySize);
+    msghdr message = {};
+    message.msg_iov = iov;
+    message.msg_iovlen = iov_count;
+    ssize_t res = sendmsg(socket_.GetDescriptor(), &message,
+                          MSG_NOSIGNAL | (zero_copy ? MSG_ZEROCOPY : 0));
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == ENOBUFS && zero_copy) {
+        copy_fallback = true;
+        continue;
+      }
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    if (zero_copy) {
+      ++next_zero_copy_send_;
+      batch_zero_copied_ = true;
+    }
+
+    shared_sent_ += res;
+    while (res > 0) {
+      const std::size_t left = shared_batch_.pieces[shared_piece_index_].size -
+          shared_piece_offset_;
+      if (static_cast<std::size_t>(res) < left) {
+        shared_piece_offset_ += res;
+        break;
+      }
+
+      res -= left;
+      ++shared_piece_index_;
+      shared_piece_offset_ = 0;
+    }
+    while (shared_message_index_ < shared_batch_.message_ends.size() &&
+           shared_batch_.message_ends[shared_message_index_] <= shared_sent_) {
+      ++shared_message_index_;
+    }
+  }
+}
+
+void Connection::CompleteZeroCopy(const ZeroCopyCompletion &completion) {
+  if (completion.copied && zero_copy_) {
+    std::cout << "Kernel copies zero-copy sends of socket " << GetDescriptor()
+              << ", falling back to regular sends" << std::endl;
+    zero_copy_ = false;
+  }
+
+  completed_ranges_[completion.first] = completion.last;
+  for (auto it = completed_ranges_.find(completed_zero_copy_sends_);
+       it != completed_ranges_.end();
+       it = completed_ranges_.find(completed_zero_copy_sends_)) {
+    completed_zero_copy_sends_ = it->second + 1;
+    completed_ranges_.erase(it);
+  }
+
+  // Numbers wrap around, so they are compared by difference
+  while (!retired_batches_.empty() &&
+         static_cast<int32_t>(completed_zero_copy_sends_ -
+                              retired_batches_.front().end_send) >= 0) {
+    retired_batches_.pop_front();
+  }
+}
+
+const char *Connection::GetChunkData(const OutputChunk &chunk) const {
+  return (chunk.data.empty() ? output_.data() + chunk.offset : chunk.data.data());
+}
+
+} // namespace sock
@@ -0,0 +1,276 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "socket.h"
+#include "shared_output.h"
+
+namespace sock {
+
+/**
+ * @brief Non-blocking client connection with input and output buffers
+ * @details Owned by Reactor. Data is read incrementally into the input buffer
+ * and written data is buffered until socket is ready to accept it. Other
+ * threads can send data through the shared output, which is interleaved with
+ * the own output on message boundaries
+ */
+class Connection {
+ public:
+  /**
+   * @brief Construct a new Connection object
+   * @details Switches socket to the non-blocking mode
+   *
+   * @param socket Connected socket
+   * @param notifier Function called from any thread, when data is written to
+   * the shared output
+   */
+  Connection(Socket socket, SharedOutput::Notifier notifier);
+
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  /**
+   * @brief Destroy the Connection object
+   * @details Closes the shared output, so other threads stop writing to it.
+   * Data of zero-copy sends is released, so the connection must not be
+   * destroyed while HasPendingZeroCopy() is true
+   */
+  ~Connection();
+
+  /**
+   * @brief Get socket descriptor
+   *
+   * @return descriptor
+   */
+  int GetDescriptor() const;
+
+  /**
+   * @brief Get ip address of the peer
+   *
+   * @return String with ip address
+   */
+  const std::string &GetPeerName() const;
+
+  /**
+   * @brief Get buffer with received but not yet consumed data
+   * @details Handler should erase consumed data from the buffer
+   *
+   * @return Input buffer
+   */
+  std::string &GetInput();
+
+  /**
+   * @brief Get buffer to format outgoing data directly into
+   * @details Everything appended to the buffer is sent in order with data
+   * passed to Write() and Attach()
+   *
+   * @return Output buffer
+   */
+  std::string &GetOutputBuffer();
+
+  /**
+   * @brief Queue data to be sent
+   *
+   * @param data Data to send. Copied to the output buffer
+   */
+  void Write(std::string_view data);
+
+  /**
+   * @brief Queue data to be sent without copying it to the output buffer
+   * @details Useful for large data like bodies of responses
+   *
+   * @param data Data to send
+   */
+  void Attach(std::string data);
+
+  /**
+   * @brief Send large data of the shared output with MSG_ZEROCOPY
+   * @details Referenced data is kept until kernel reports that it was sent.
+   * Zero copy is turned off, if kernel reports copying, e.g. on loopback
+   *
+   * @return true If zero copy is supported
+   */
+  bool EnableZeroCopy();
+
+  /**
+   * @brief Get output, which other threads can write to
+   *
+   * @return Shared output of the connection
+   */
+  const std::shared_ptr<SharedOutput> &GetSharedOutput() const;
+
+  /**
+   * @brief Close connection as soon as all queued data is sent
+   */
+  void Close();
+
+  /**
+   * @brief Check if Close() was requested
+   *
+   * @return true If connection is closing
+   * @return false In other way
+   */
+  bool IsClosing() const;
+
+  /**
+   * @brief Check if there is queued data to be sent
+   *
+   * @return true If output buffer or taken shared data is not empty
+   * @return false In other way
+   */
+  bool HasPendingOutput() const;
+
+  /**
+   * @brief Check if kernel may still read data of zero-copy sends
+   *
+   * @return true If some zero-copy sends are not completed yet
+   * @return false In other way
+   */
+  bool HasPendingZeroCopy() const;
+
+  /**
+   * @brief Stop sending and receiving data, but keep the socket open
+   * @details Closes the shared output. Socket stays open, so completions of
+   * zero-copy sends can still be received from its error queue
+   */
+  void Shutdown();
+
+  /**
+   * @brief Process notifications from the socket error queue
+   * @details Releases data of completed zero-copy sends
+   *
+   * @return true If there was no real error
+   * @return false If connection is broken
+   */
+  bool HandleErrorQueue();
+
+  /**
+   * @brief Read all available data into the input buffer
+   *
+   * @return true If some data was read or socket has nothing to read yet
+   * @return false If peer closed connection or error occurred
+   */
+  bool ReadAvailable();
+
+  /**
+   * @brief Send as much of queued data as socket accepts
+   * @details All queued pieces are sent with one gather call. Shared output
+   * goes after them, except the rest of its message, which was sent partially
+   *
+   * @return true If no error occurred
+   * @return false If connection is broken
+   */
+  bool Flush();
+
+ private:
+  /**
+   * @brief Piece of queued data
+   */
+  struct OutputChunk {
+    std::size_t offset; //!< Offset in output_. Used if data is empty
+    std::size_t size; //!< Size of the piece
+    std::string data; //!< Attached data
+  };
+
+  Socket socket_; //!< Connected socket
+  std::string peer_name_; //!< Peer ip address
+  std::string input_; //!< Received data
+  std::string output_; //!< Formatted data waiting for sending
+  std::size_t output_committed_; //!< Size of output_ covered by chunks_
+  std::vector<OutputChunk> chunks_; //!< Queued pieces in sending order
+  std::size_t chunk_index_; //!< Index of the first not completely sent piece
+  std::size_t chunk_offset_; //!< Number of already sent bytes of that piece
+  bool closing_; //!< True, if Close() was requested
+  /**
+   * @brief Sent batch, which data may still be used by kernel
+   */
+  struct RetiredBatch {
+    SharedOutput::Batch batch; //!< Sent messages
+    uint32_t end_send; //!< Number of the zero-copy send after the last one of batch
+  };
+
+  const std::shared_ptr<SharedOutput> shared_output_; //!< Output of other threads
+  SharedOutput::Batch shared_batch_; //!< Messages taken from the shared output
+  std::size_t shared_piece_index_; //!< Index of the first not sent piece
+  std::size_t shared_piece_offset_; //!< Number of already sent bytes of that piece
+  std::size_t shared_message_index_; //!< Index of the first not sent message
+  std::size_t shared_sent_; //!< Number of sent bytes of shared_batch_
+  bool zero_copy_; //!< True, if large data is sent with MSG_ZEROCOPY
+  bool batch_zero_copied_; //!< True, if shared_batch_ was sent with zero copy
+  uint32_t next_zero_copy_send_; //!< Number of the next zero-copy send
+  uint32_t completed_zero_copy_sends_; //!< All sends before it are completed
+  //! Completed sends, which came out of order: first -> last
+  std::unordered_map<uint32_t, uint32_t> completed_ranges_;
+  std::deque<RetiredBatch> retired_batches_; //!< Batches waiting for completion
+
+  /**
+   * @brief Turn recently formatted part of output_ into a chunk
+   */
+  void CommitOutputBuffer();
+
+  /**
+   * @brief Send queued pieces of the own output
+   *
+   * @return true If no error occurred
+   * @return false If connection is broken
+   */
+  bool FlushChunks();
+
+  /**
+   * @brief Send messages taken from the shared output
+   *
+   * @param current_message_only If true, only the rest of the partially sent
+   * message is sent. Otherwise new messages are taken while socket accepts them
+   * @return true If no error occurred
+   * @return false If connection is broken
+   */
+  bool FlushSharedData(bool current_message_only);
+
+  /**
+   * @brief Remember completed zero-copy sends and release their batches
+   *
+   * @param completion Notification from the error queue
+   */
+  void CompleteZeroCopy(const ZeroCopyCompletion &completion);
+
+  /**
+   * @brief Get data of the chunk
+   *
+   * @param chunk Queued piece
+   * @return Pointer to the data
+   */
+  const char *GetChunkData(const OutputChunk &chunk) const;
+};
+
+} // namespace sock
@@ -0,0 +1,239 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "datagram_batch.h"
+
+#include <cstring>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Reorder elements of the vectors in place
+ * @details Follows cycles of the permutation swapping elements, so nothing is
+ * allocated
+ *
+ * @param order New position i takes element order[i]. Becomes identity
+ * @param values Vectors of the same size to reorder
+ */
+template <typename... T>
+void Reorder(std::vector<std::size_t> &order, std::vector<T> &...values) {
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    std::size_t position = i;
+    while (order[position] != i) {
+      const std::size_t source = order[position];
+      (std::swap(values[position], values[source]), ...);
+      order[position] = position;
+      position = source;
+    }
+    order[position] = position;
+  }
+}
+
+} // namespace
+
+namespace sock {
+
+DatagramBatch::DatagramBatch() :
+messages_(),
+parts_(),
+first_parts_(),
+addresses_(),
+sockets_(),
+segment_sizes_(),
+send_times_(),
+order_(),
+controls_() {}
+
+void DatagramBatch::Add(const Address &address, Span<const Span<const Byte>> parts,
+                        const uint16_t segment_size, const uint64_t send_time) {
+  AddMessage(&address, nullptr, parts, segment_size, send_time);
+}
+
+void DatagramBatch::Add(Socket &socket, Span<const Span<const Byte>> parts,
+                        const uint16_t segment_size, const uint64_t send_time) {
+  AddMessage(nullptr, &socket, parts, segment_size, send_time);
+}
+
+void DatagramBatch::AddMessage(const Address *address, Socket *socket,
+                               Span<const Span<const Byte>> parts,
+                               const uint16_t segment_size, const uint64_t send_time) {
+  first_parts_.push_back(parts_.size());
+  for (const Span<const Byte> &part : parts) {
+    parts_.push_back({const_cast<Byte *>(part.data()), part.size()});
+  }
+
+  mmsghdr message = {};
+  if (address != nullptr) {
+    message.msg_hdr.msg_name = const_cast<sockaddr *>(address->GetSockaddr());
+    message.msg_hdr.msg_namelen = address->GetSize();
+  }
+  message.msg_hdr.msg_iovlen = parts.size();
+  messages_.push_back(message);
+  addresses_.push_back(address);
+  sockets_.push_back(socket);
+  segment_sizes_.push_back(segment_size);
+  send_times_.push_back(send_time);
+}
+
+void DatagramBatch::Clear() {
+  messages_.clear();
+  parts_.clear();
+  first_parts_.clear();
+  addresses_.clear();
+  sockets_.clear();
+  segment_sizes_.clear();
+  send_times_.clear();
+}
+
+std::size_t DatagramBatch::Size() const {
+  return messages_.size();
+}
+
+const Address *DatagramBatch::GetAddress(const std::size_t index) const {
+  return addresses_[index];
+}
+
+Socket *DatagramBatch::GetSocket(const std::size_t index) const {
+  return sockets_[index];
+}
+
+Span<const iovec> DatagramBatch::GetParts(const std::size_t index) const {
+  return {parts_.data() + first_parts_[index], messages_[index].msg_hdr.msg_iovlen};
+}
+
+uint16_t DatagramBatch::GetSegmentSize(const std::size_t index) const {
+  return segment_sizes_[index];
+}
+
+uint64_t DatagramBatch::GetSendTime(const std::size_t index) const {
+  return send_times_[index];
+}
+
+void DatagramBatch::SortBySendTime() {
+  if (std::is_sorted(send_times_.begin(), send_times_.end())) {
+    return;
+  }
+
+  order_.resize(messages_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  // Ties are broken by index instead of std::stable_sort(), which allocates
+  // its buffer on every call
+  std::sort(order_.begin(), order_.end(),
+            [this](const std::size_t lhs, const std::size_t rhs) {
+              return std::tie(send_times_[lhs], lhs) < std::tie(send_times_[rhs], rhs);
+            });
+
+  // Parts stay in place, only their indices are reordered
+  Reorder(order_, messages_, first_parts_, addresses_, sockets_, segment_sizes_,
+          send_times_);
+}
+
+std::size_t DatagramBatch::Split(const std::size_t index) {
+  const std::size_t segment_size = segment_sizes_[index];
+  const std::size_t first_part = first_parts_[index];
+  const std::size_t parts_count = messages_[index].msg_hdr.msg_iovlen;
+
+  // Parts stay in place, segments only point to their ranges
+  std::vector<std::size_t> segment_first_parts;
+  std::size_t segment_bytes = 0;
+  for (std::size_t i = 0; i < parts_count; ++i) {
+    if (segment_bytes == 0) {
+      segment_first_parts.push_back(first_part + i);
+    }
+    segment_bytes += parts_[first_part + i].iov_len;
+    if (segment_bytes >= segment_size) {
+      segment_bytes = 0;
+    }
+  }
+
+  const std::size_t count = segment_first_parts.size();
+  std::vector<mmsghdr> messages(count, messages_[index]);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::size_t end_part = (i + 1 < count ? segment_first_parts[i + 1] :
+                                  first_part + parts_count);
+    messages[i].msg_hdr.msg_iovlen = end_part - segment_first_parts[i];
+  }
+
+  messages_.erase(messages_.begin() + index);
+  messages_.insert(messages_.begin() + index, messages.begin(), messages.end());
+  first_parts_.erase(first_parts_.begin() + index);
+  first_parts_.insert(first_parts_.begin() + index, segment_first_parts.begin(),
+                      segment_first_parts.end());
+  const Address *const address = addresses_[index];
+  addresses_.insert(addresses_.begin() + index, count - 1, address);
+  Socket *const socket = sockets_[index];
+  sockets_.insert(sockets_.begin() + index, count - 1, socket);
+  segment_sizes_[index] = 0;
+  segment_sizes_.insert(segment_sizes_.begin() + index, count - 1, 0);
+  const uint64_t send_time = send_times_[index];
+  send_times_.insert(send_times_.begin() + index, count - 1, send_time);
+
+  return count;
+}
+
+void DatagramBatch::LinkParts(const std::size_t first, const std::size_t end,
+                              const bool with_send_times) {
+  if (controls_.size() < messages_.size()) {
+    controls_.resize(messages_.size());
+  }
+
+  for (std::size_t i = first; i < end; ++i) {
+    msghdr &header = messages_[i].msg_hdr;
+    header.msg_iov = parts_.data() + first_parts_[i];
+    header.msg_control = nullptr;
+    header.msg_controllen = 0;
+
+    const bool segmented = (segment_sizes_[i] != 0);
+    const bool timed = (with_send_times && send_times_[i] != 0);
+    if (!segmented && !timed) {
+      continue;
+    }
+
+    header.msg_control = controls_[i].data();
+    header.msg_controllen = (segmented ? CMSG_SPACE(sizeof(uint16_t)) : 0) +
+                            (timed ? CMSG_SPACE(sizeof(uint64_t)) : 0);
+    cmsghdr *control = CMSG_FIRSTHDR(&header);
+    if (segmented) {
+      control->cmsg_level = IPPROTO_UDP;
+      control->cmsg_type = UDP_SEGMENT;
+      control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      std::memcpy(CMSG_DATA(control), &segment_sizes_[i], sizeof(uint16_t));
+      control = CMSG_NXTHDR(&header, control);
+    }
+    if (timed) {
+      control->cmsg_level = SOL_SOCKET;
+      control->cmsg_type = SCM_TXTIME;
+      control->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+      std::memcpy(CMSG_DATA(control), &send_times_[i], sizeof(uint64_t));
+    }
+  }
+}
+
+} // namespace sock
@@ -0,0 +1,198 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/udp.h>
+
+#include <array>
+#include <vector>
+
+#include "byte.h"
+#include "span.h"
+#include "address.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103 // Since Linux 4.18
+#endif
+
+namespace sock {
+
+class Socket;
+
+/**
+ * @brief Datagrams collected to be sent with as few system calls as possible
+ * @details Only pointers to the data are kept, so data, addresses and
+ * sockets must stay alive until the batch is sent. Datagrams are either
+ * addressed and sent through the socket sending the batch, or sent through
+ * their own connected sockets
+ */
+class DatagramBatch {
+ public:
+  DatagramBatch();
+
+  /**
+   * @brief Add datagram to the batch
+   *
+   * @param address Destination
+   * @param parts Parts of the datagram in order
+   * @param segment_size If not 0, kernel splits the datagram into datagrams
+   * of this size (UDP GSO). Only the last one may be shorter
+   * @param send_time Time in nanoseconds of CLOCK_MONOTONIC, when the datagram
+   * should leave the host. 0 means as soon as possible
+   */
+  void Add(const Address &address, Span<const Span<const Byte>> parts,
+           uint16_t segment_size = 0, uint64_t send_time = 0);
+
+  /**
+   * @brief Add datagram to be sent through connected socket
+   *
+   * @param socket Connected socket, which must send the datagram
+   * @param parts Parts of the datagram in order
+   * @param segment_size If not 0, kernel splits the datagram into datagrams
+   * of this size (UDP GSO). Only the last one may be shorter
+   * @param send_time Time in nanoseconds of CLOCK_MONOTONIC, when the datagram
+   * should leave the host. 0 means as soon as possible
+   */
+  void Add(Socket &socket, Span<const Span<const Byte>> parts,
+           uint16_t segment_size = 0, uint64_t send_time = 0);
+
+  /**
+   * @brief Remove all datagrams keeping memory for reuse
+   */
+  void Clear();
+
+  std::size_t Size() const;
+
+  /**
+   * @brief Get destination of the datagram
+   *
+   * @param index Datagram index
+   * @return Destination or nullptr if datagram is sent through connected socket
+   */
+  const Address *GetAddress(std::size_t index) const;
+
+  /**
+   * @brief Get connected socket of the datagram
+   *
+   * @param index Datagram index
+   * @return Connected socket or nullptr if datagram is addressed
+   */
+  Socket *GetSocket(std::size_t index) const;
+
+  /**
+   * @brief Get parts of the datagram
+   *
+   * @param index Datagram index
+   * @return Parts of the datagram
+   */
+  Span<const iovec> GetParts(std::size_t index) const;
+
+  /**
+   * @brief Get GSO segment size of the datagram
+   *
+   * @param index Datagram index
+   * @return Segment size or 0 if datagram is not segmented
+   */
+  uint16_t GetSegmentSize(std::size_t index) const;
+
+  /**
+   * @brief Get send time of the datagram
+   *
+   * @param index Datagram index
+   * @return Time in nanoseconds of CLOCK_MONOTONIC or 0
+   */
+  uint64_t GetSendTime(std::size_t index) const;
+
+  /**
+   * @brief Order datagrams by send time keeping order of equal ones
+   * @details Doesn't allocate, once the batch reached its size
+   */
+  void SortBySendTime();
+
+  /**
+   * @brief Replace segmented datagram with its segments
+   * @details Segments take the place and send time of the datagram, so the
+   * order of the batch is kept. Used when kernel refuses to segment it
+   *
+   * @param index Index of the segmented datagram
+   * @return Number of datagrams it was split into
+   */
+  std::size_t Split(std::size_t index);
+
+ private:
+  //! Buffer for control messages with segment size and send time
+  using Control = std::array<char, CMSG_SPACE(sizeof(uint16_t)) +
+                                   CMSG_SPACE(sizeof(uint64_t))>;
+
+  friend class Socket;
+
+  std::vector<mmsghdr> messages_; //!< Headers of the datagrams
+  std::vector<iovec> parts_; //!< Parts of all datagrams
+  std::vector<std::size_t> first_parts_; //!< Index of the first part of every datagram
+  std::vector<const Address *> addresses_; //!< Destination of every datagram
+  std::vector<Socket *> sockets_; //!< Connected socket of every datagram
+  std::vector<uint16_t> segment_sizes_; //!< GSO segment size of every datagram
+  std::vector<uint64_t> send_times_; //!< Send time of every datagram
+  std::vector<std::size_t> order_; //!< Buffer for sorting
+  std::vector<Control> controls_; //!< Control messages of segmented datagrams
+
+  /**
+   * @brief Add addressed datagram or datagram of connected socket
+   *
+   * @param address Destination or nullptr
+   * @param socket Connected socket or nullptr
+   * @param parts Parts of the datagram in order
+   * @param segment_size GSO segment size or 0
+   * @param send_time Send time or 0
+   */
+  void AddMessage(const Address *address, Socket *socket,
+                  Span<const Span<const Byte>> parts, uint16_t segment_size,
+                  uint64_t send_time);
+
+  /**
+   * @brief Point message headers to their parts and control messages
+   * @details Done right before sending, because vectors can be reallocated
+   * while datagrams are added
+   *
+   * @param first Index of the first datagram to link
+   * @param end Index after the last datagram to link
+   * @param with_send_times If true, send times are passed to kernel (SO_TXTIME)
+   */
+  void LinkParts(std::size_t first, std::size_t end, bool with_send_times);
+};
+
+/**
+ * @brief Result of the batch sending
+ */
+struct BatchSendResult {
+  std::size_t sent; //!< Index of the first not sent datagram
+  int error; //!< errno of the datagram, that stopped sending, or 0
+};
+
+} // namespace sock
@@ -0,0 +1,369 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "reactor.h"
+
+#include <cstring>
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <optional>
+#include <algorithm>
+
+#include "exception.h"
+
+namespace {
+
+//! Max number of events processed in one epoll_wait() call
+const int kMaxEvents = 64;
+//! Interval of checking completions of lingering connections, ms
+const int kLingerPollInterval = 100;
+
+/**
+ * @brief Add descriptor to epoll instance
+ *
+ * @param epoll_descriptor Epoll instance
+ * @param descriptor Descriptor to watch
+ * @param events Epoll events mask
+ */
+void AddToEpoll(const int epoll_descriptor, const int descriptor,
+                const uint32_t events) {
+  epoll_event event = {};
+  event.events = events;
+  event.data.fd = descriptor;
+  if (epoll_ctl(epoll_descriptor, EPOLL_CTL_ADD, descriptor, &event) < 0) {
+    throw sock::SocketException(std::string("Can't add descriptor to epoll: ") +
+                                strerror(errno));
+  }
+}
+
+} // namespace
+
+namespace sock {
+
+Reactor::Reactor(ServerSocket &server_socket, HandlerFactory handler_factory) :
+server_socket_(server_socket),
+handler_factory_(std::move(handler_factory)),
+epoll_descriptor_(epoll_create1(EPOLL_CLOEXEC)),
+stop_descriptor_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+wake_descriptor_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+signal_descriptor_(-1),
+timer_descriptor_(-1),
+timer_handler_(),
+zero_copy_(false),
+clients_(),
+ready_mutex_(),
+ready_descriptors_(),
+flushed_descriptors_(),
+lingering_connections_() {
+  if (epoll_descriptor_ < 0 || stop_descriptor_ < 0 || wake_descriptor_ < 0) {
+    close(epoll_descriptor_);
+    close(stop_descriptor_);
+    close(wake_descriptor_);
+    throw SocketException(std::string("Can't create event loop: ") +
+                          strerror(errno));
+  }
+
+  AddToEpoll(epoll_descriptor_, server_socket_.GetDescriptor(), EPOLLIN);
+  AddToEpoll(epoll_descriptor_, stop_descriptor_, EPOLLIN);
+  AddToEpoll(epoll_descriptor_, wake_descriptor_, EPOLLIN);
+}
+
+Reactor::~Reactor() {
+  // Connections are closed by their sockets. Shared outputs are closed too,
+  // so other threads don't notify destroyed reactor
+  clients_.clear();
+  lingering_connections_.clear();
+  if (signal_descriptor_ >= 0) {
+    close(signal_descriptor_);
+  }
+  if (timer_descriptor_ >= 0) {
+    close(timer_descriptor_);
+  }
+  close(wake_descriptor_);
+  close(stop_descriptor_);
+  close(epoll_descriptor_);
+}
+
+void Reactor::StopOnSignals(std::initializer_list<int> signals) {
+  sigset_t mask;
+  sigemptyset(&mask);
+  for (int signal_number : signals) {
+    sigaddset(&mask, signal_number);
+  }
+
+  if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+    throw SocketException("Can't block signals");
+  }
+
+  signal_descriptor_ = signalfd(signal_descriptor_, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (signal_descriptor_ < 0) {
+    throw SocketException(std::string("Can't create signalfd: ") + strerror(errno));
+  }
+
+  AddToEpoll(epoll_descriptor_, signal_descriptor_, EPOLLIN);
+}
+
+void Reactor::SetTimer(const std::chrono::milliseconds interval,
+                       TimerHandler timer_handler) {
+  if (timer_descriptor_ < 0) {
+    timer_descriptor_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_descriptor_ < 0) {
+      throw SocketException(std::string("Can't create timerfd: ") + strerror(errno));
+    }
+    AddToEpoll(epoll_descriptor_, timer_descriptor_, EPOLLIN);
+  }
+
+  itimerspec spec = {};
+  spec.it_interval.tv_sec = interval.count() / 1000;
+  spec.it_interval.tv_nsec = interval.count() % 1000 * 1'000'000;
+  spec.it_value = spec.it_interval;
+  if (timerfd_settime(timer_descriptor_, 0, &spec, nullptr) < 0) {
+    throw SocketException(std::string("Can't set timer: ") + strerror(errno));
+  }
+
+  timer_handler_ = std::move(timer_handler);
+}
+
+void Reactor::EnableZeroCopy() {
+  zero_copy_ = true;
+}
+
+void Reactor::Run() {
+  epoll_event events[kMaxEvents];
+
+  for (;;) {
+    // Lingering connections are not in epoll, so they are checked periodically
+    const int events_count = epoll_wait(
+        epoll_descriptor_, events, kMaxEvents,
+        (lingering_connections_.empty() ? -1 : kLingerPollInterval));
+    if (!lingering_connections_.empty()) {
+      ReleaseLingeringConnections();
+    }
+    if (events_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw SocketException(std::string("epoll_wait failed: ") + strerror(errno));
+    }
+
+    for (int i = 0; i < events_count; ++i) {
+      const int descriptor = events[i].data.fd;
+
+      if (descriptor == stop_descriptor_ || descriptor == signal_descriptor_) {
+        return;
+      }
+
+      if (descriptor == server_socket_.GetDescriptor()) {
+        AcceptClients();
+        continue;
+      }
+
+      if (descriptor == wake_descriptor_) {
+        FlushReadyConnections();
+        continue;
+      }
+
+      if (descriptor == timer_descriptor_) {
+        uint64_t expirations = 0;
+        if (read(timer_descriptor_, &expirations, sizeof(expirations)) > 0) {
+          timer_handler_();
+        }
+        continue;
+      }
+
+      auto it = clients_.find(descriptor);
+      if (it != clients_.end()) {
+        HandleClientEvents(it->second, events[i].events);
+      }
+    }
+  }
+}
+
+void Reactor::Stop() {
+  const uint64_t value = 1;
+  // Nothing to do on failure: counter is already non-zero then
+  [[maybe_unused]] ssize_t res = write(stop_descriptor_, &value, sizeof(value));
+}
+
+void Reactor::AcceptClients() {
+  for (;;) {
+    std::optional<Socket> socket_opt;
+    try {
+      socket_opt = server_socket_.Accept();
+    } catch (const AcceptError &ex) {
+      // E.g. out of descriptors. Try again on the next event
+      std::cout << ex.what() << std::endl;
+      return;
+    }
+
+    if (!socket_opt.has_value()) {
+      return;
+    }
+
+    const int descriptor = socket_opt->GetDescriptor();
+    auto connection = std::make_unique<Connection>(
+        std::move(socket_opt.value()), [this, descriptor] { NotifyReady(descriptor); });
+    if (zero_copy_ && !connection->EnableZeroCopy()) {
+      std::cout << "Zero copy isn't supported for socket " << descriptor << std::endl;
+    }
+    AddToEpoll(epoll_descriptor_, descriptor, EPOLLIN | EPOLLRDHUP);
+    clients_.emplace(descriptor, Client{std::move(connection), handler_factory_()});
+    std::cout << "Connected client on socket " << descriptor << std::endl;
+  }
+}
+
+void Reactor::HandleClientEvents(Client &client, const uint32_t events) {
+  Connection &connection = *client.connection;
+  const int descriptor = connection.GetDescriptor();
+
+  // Error queue holds completions of zero-copy sends as well as errors
+  if ((events & EPOLLERR) && !connection.HandleErrorQueue()) {
+    std::cout << "Client on socket " << descriptor << " disconnected" << std::endl;
+    CloseConnection(descriptor);
+    return;
+  }
+
+  if (events & EPOLLIN) {
+    const bool alive = connection.ReadAvailable();
+    if (!connection.GetInput().empty() && !connection.IsClosing()) {
+      try {
+        client.data_handler(connection);
+      } catch (const std::exception &ex) {
+        std::cout << "Error on socket " << descriptor << ": " << ex.what()
+                  << std::endl;
+        connection.Close();
+      }
+    }
+
+    if (!alive) {
+      std::cout << "Client on socket " << descriptor << " disconnected" << std::endl;
+      CloseConnection(descriptor);
+      return;
+    }
+  } else if (events & EPOLLHUP) {
+    std::cout << "Client on socket " << descriptor << " disconnected" << std::endl;
+    CloseConnection(descriptor);
+    return;
+  }
+
+  FlushConnection(connection);
+}
+
+void Reactor::FlushReadyConnections() {
+  uint64_t value = 0;
+  [[maybe_unused]] ssize_t res = read(wake_descriptor_, &value, sizeof(value));
+
+  {
+    std::lock_guard lock(ready_mutex_);
+    flushed_descriptors_.swap(ready_descriptors_);
+  }
+
+  // Descriptor may belong to a new connection already. Extra flush is harmless
+  for (const int descriptor : flushed_descriptors_) {
+    auto it = clients_.find(descriptor);
+    if (it != clients_.end()) {
+      FlushConnection(*it->second.connection);
+    }
+  }
+  flushed_descriptors_.clear();
+}
+
+void Reactor::FlushConnection(Connection &connection) {
+  const int descriptor = connection.GetDescriptor();
+
+  if (!connection.Flush()) {
+    std::cout << "Client on socket " << descriptor
+              << " disconnected while was waiting for response" << std::endl;
+    CloseConnection(descriptor);
+    return;
+  }
+
+  if (connection.IsClosing() && !connection.HasPendingOutput()) {
+    CloseConnection(descriptor);
+    return;
+  }
+
+  UpdateInterest(connection);
+}
+
+void Reactor::NotifyReady(const int descriptor) {
+  std::lock_guard lock(ready_mutex_);
+  ready_descriptors_.push_back(descriptor);
+  if (ready_descriptors_.size() == 1) {
+    const uint64_t value = 1;
+    // Nothing to do on failure: counter is already non-zero then
+    [[maybe_unused]] ssize_t res = write(wake_descriptor_, &value, sizeof(value));
+  }
+}
+
+void Reactor::UpdateInterest(const Connection &connection) {
+  epoll_event event = {};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  if (connection.HasPendingOutput()) {
+    event.events |= EPOLLOUT;
+  }
+  event.data.fd = connection.GetDescriptor();
+  epoll_ctl(epoll_descriptor_, EPOLL_CTL_MOD, event.data.fd, &event);
+}
+
+void Reactor::CloseConnection(const int descriptor) {
+  epoll_ctl(epoll_descriptor_, EPOLL_CTL_DEL, descriptor, nullptr);
+
+  auto it = clients_.find(descriptor);
+  std::unique_ptr<Connection> &connection = it->second.connection;
+  connection->HandleErrorQueue();
+  if (connection->HasPendingZeroCopy()) {
+    connection->Shutdown();
+    lingering_connections_.push_back(std::move(connection));
+    std::cout << "Socket " << descriptor
+              << " closed, waiting for its zero-copy sends" << std::endl;
+  } else {
+    std::cout << "Socket " << descriptor << " closed" << std::endl;
+  }
+  clients_.erase(it);
+}
+
+void Reactor::ReleaseLingeringConnections() {
+  for (const std::unique_ptr<Connection> &connection : lingering_connections_) {
+    connection->HandleErrorQueue();
+  }
+
+  // Destroyed connections close their sockets
+  lingering_connections_.erase(
+      std::remove_if(lingering_connections_.begin(), lingering_connections_.end(),
+                     [](const std::unique_ptr<Connection> &connection) {
+                       return !connection->HasPendingZeroCopy();
+                     }),
+      lingering_connections_.end());
+}
+
+} // namespace sock
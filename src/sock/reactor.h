@@ -0,0 +1,192 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <initializer_list>
+#include <mutex>
+
+#include "server_socket.h"
+#include "connection.h"
+
+namespace sock {
+
+/**
+ * @brief Single-threaded epoll event loop serving all client connections
+ * @details Accepts clients, reads their data incrementally and writes
+ * buffered output without blocking. Data written to shared outputs of the
+ * connections by other threads is sent from the loop too. Can be stopped from
+ * any thread or by signal
+ */
+class Reactor {
+ public:
+  //! Function called every time new data arrives to the connection
+  using DataHandler = std::function<void(Connection &)>;
+  //! Function creating handler for every new connection. Handler can keep
+  //! per-connection state
+  using HandlerFactory = std::function<DataHandler()>;
+  //! Function called periodically from Run()
+  using TimerHandler = std::function<void()>;
+
+  /**
+   * @brief Construct a new Reactor object
+   *
+   * @param server_socket Listening socket. Must outlive the Reactor
+   * @param handler_factory Factory of received data handlers
+   */
+  Reactor(ServerSocket &server_socket, HandlerFactory handler_factory);
+
+  Reactor(const Reactor &) = delete;
+  Reactor &operator=(const Reactor &) = delete;
+
+  ~Reactor();
+
+  /**
+   * @brief Stop Run() when one of the signals is received
+   * @details Signals are blocked in the calling thread, so this method should
+   * be called before any other thread is started
+   *
+   * @param signals Signal numbers
+   */
+  void StopOnSignals(std::initializer_list<int> signals);
+
+  /**
+   * @brief Call handler periodically from Run()
+   * @details Replaces previously set handler
+   *
+   * @param interval Time between calls
+   * @param timer_handler Handler to call
+   */
+  void SetTimer(std::chrono::milliseconds interval, TimerHandler timer_handler);
+
+  /**
+   * @brief Send large data of shared outputs of new connections with MSG_ZEROCOPY
+   * @details Pays off for frames of tens of kilobytes and more on real network
+   * interfaces. Connections fall back to regular sends, if kernel copies data
+   * anyway
+   */
+  void EnableZeroCopy();
+
+  /**
+   * @brief Serve connections until Stop() is called or signal is received
+   */
+  void Run();
+
+  /**
+   * @brief Wake up Run() and make it return. Thread-safe
+   */
+  void Stop();
+
+ private:
+  /**
+   * @brief Connection with its own data handler
+   */
+  struct Client {
+    std::unique_ptr<Connection> connection;
+    DataHandler data_handler;
+  };
+
+  ServerSocket &server_socket_; //!< Listening socket
+  HandlerFactory handler_factory_; //!< Factory of received data handlers
+  int epoll_descriptor_; //!< Epoll instance
+  int stop_descriptor_; //!< Eventfd used to stop the loop
+  int wake_descriptor_; //!< Eventfd signaled when shared outputs get data
+  int signal_descriptor_; //!< Signalfd with stop signals or -1
+  int timer_descriptor_; //!< Timerfd of periodic handler or -1
+  TimerHandler timer_handler_; //!< Periodic handler
+  bool zero_copy_; //!< True, if new connections use zero copy
+  std::unordered_map<int, Client> clients_; //!< Descriptor -> Client
+  std::mutex ready_mutex_; //!< Mutex to protect ready_descriptors_
+  //! Descriptors of connections, which shared outputs got data
+  std::vector<int> ready_descriptors_;
+  std::vector<int> flushed_descriptors_; //!< Buffer for ready descriptors
+  //! Closed connections, which zero-copy sends are not completed yet. Their
+  //! sockets stay open to receive completions, so their data isn't released
+  //! while kernel still reads it
+  std::vector<std::unique_ptr<Connection>> lingering_connections_;
+
+  /**
+   * @brief Accept all pending clients
+   */
+  void AcceptClients();
+
+  /**
+   * @brief Process events of one client
+   *
+   * @param client Client with events
+   * @param events Epoll events mask
+   */
+  void HandleClientEvents(Client &client, uint32_t events);
+
+  /**
+   * @brief Send connections data, which was written by other threads
+   */
+  void FlushReadyConnections();
+
+  /**
+   * @brief Send queued data and close connection if it's done
+   *
+   * @param connection Connection to flush
+   */
+  void FlushConnection(Connection &connection);
+
+  /**
+   * @brief Remember that shared output of the connection got data
+   * @details Called from any thread
+   *
+   * @param descriptor Connection descriptor
+   */
+  void NotifyReady(int descriptor);
+
+  /**
+   * @brief Wait for writability only while there is pending output
+   *
+   * @param connection Connection to update
+   */
+  void UpdateInterest(const Connection &connection);
+
+  /**
+   * @brief Close connection and forget about it
+   * @details Connection with not completed zero-copy sends is shut down and
+   * kept lingering until kernel completes them
+   *
+   * @param descriptor Connection descriptor
+   */
+  void CloseConnection(int descriptor);
+
+  /**
+   * @brief Receive completions of lingering connections and destroy the ones
+   * which have nothing pending
+   */
+  void ReleaseLingeringConnections();
+};
+
+} // namespace sock
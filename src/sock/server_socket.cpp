@@ -53,7 +53,7 @@ Socket(type) {
     throw BindError(std::string("Can't bind socket: ") + strerror(errno));
   }
 
-  if ((type == Type::kTcp) && listen(descriptor_, 1) < 0) {
+  if ((type == Type::kTcp) && listen(descriptor_, SOMAXCONN) < 0) {
     throw ListenError(std::string("Listen: ") + strerror(errno));
   }
 }
@@ -80,4 +80,21 @@ std::optional<Socket> ServerSocket::TryAccept(int sec) const {
   return Socket(client_descriptor);
 }
 
+std::optional<Socket> ServerSocket::Accept() const {
+  int client_descriptor = -1;
+  do {
+    client_descriptor = accept4(descriptor_, nullptr, nullptr,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
+  } while (client_descriptor < 0 && errno == EINTR);
+
+  if (client_descriptor < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED) {
+      return std::nullopt;
+    }
+    throw AcceptError(std::string("Can't accept client: ") + strerror(errno));
+  }
+
+  return Socket(client_descriptor);
+}
+
 } // namespace sock
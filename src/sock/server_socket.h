@@ -52,6 +52,13 @@ class ServerSocket : public Socket {
    * @return Socket associated with client, if client has connected in sec seconds
    */
   std::optional<Socket> TryAccept(int sec) const;
+
+  /**
+   * @brief Accept pending client without waiting
+   *
+   * @return Socket associated with client, if there was pending connection
+   */
+  std::optional<Socket> Accept() const;
 };
 
 } // namespace sock
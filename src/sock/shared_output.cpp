@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "shared_output.h"
+
+#include <utility>
+
+namespace sock {
+
+const Byte *SharedOutput::Batch::GetPieceData(const Piece &piece) const {
+  return (piece.external != nullptr ? piece.external : data.data() + piece.offset);
+}
+
+void SharedOutput::Batch::Clear() {
+  data.clear();
+  pieces.clear();
+  message_ends.clear();
+  size = 0;
+  owners.clear();
+}
+
+SharedOutput::SharedOutput(const std::size_t capacity, Notifier notifier) :
+capacity_(capacity),
+mutex_(),
+notifier_(std::move(notifier)),
+batch_(),
+closed_(false) {}
+
+bool SharedOutput::Write(Span<const Span<const Byte>> parts,
+                         const std::size_t parts_per_message,
+                         std::shared_ptr<const void> owner) {
+  std::size_t size = 0;
+  for (const Span<const Byte> &part : parts) {
+    size += part.size();
+  }
+
+  std::lock_guard lock(mutex_);
+  if (closed_ || size == 0 || batch_.size + size > capacity_) {
+    return false;
+  }
+
+  const bool was_empty = batch_.pieces.empty();
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    const Span<const Byte> &part = parts[i];
+    if (owner && part.size() >= kMinReferencedSize) {
+      batch_.pieces.push_back({part.data(), 0, part.size()});
+    } else if (!part.empty()) {
+      // Copied parts in a row form one piece
+      if (batch_.pieces.empty() || batch_.pieces.back().external != nullptr) {
+        batch_.pieces.push_back({nullptr, batch_.data.size(), 0});
+      }
+      batch_.data.insert(batch_.data.end(), part.begin(), part.end());
+      batch_.pieces.back().size += part.size();
+    }
+
+    batch_.size += part.size();
+    if ((i + 1) % parts_per_message == 0 || i + 1 == parts.size()) {
+      batch_.message_ends.push_back(batch_.size);
+    }
+  }
+  if (owner) {
+    batch_.owners.push_back(std::move(owner));
+  }
+
+  if (was_empty && notifier_) {
+    notifier_();
+  }
+  return true;
+}
+
+bool SharedOutput::Take(Batch &batch) {
+  std::lock_guard lock(mutex_);
+  std::swap(batch_, batch);
+  return !batch.pieces.empty();
+}
+
+std::size_t SharedOutput::GetSize() const {
+  std::lock_guard lock(mutex_);
+  return batch_.size;
+}
+
+std::size_t SharedOutput::GetCapacity() const {
+  return capacity_;
+}
+
+void SharedOutput::Close() {
+  std::lock_guard lock(mutex_);
+  closed_ = true;
+  notifier_ = nullptr;
+  batch_.Clear();
+}
+
+} // namespace sock
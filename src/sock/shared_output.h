@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+#include "byte.h"
+#include "span.h"
+
+namespace sock {
+
+/**
+ * @brief Output of the connection, which other threads can write to
+ * @details Data is written as whole messages. Connection takes them from the
+ * reactor thread and sends them only between its own responses, so responses
+ * never wait behind a long queue of data. Large parts of messages can be
+ * referenced instead of copied, while their owner is kept alive
+ */
+class SharedOutput {
+ public:
+  //! Function called when queue becomes non-empty. Called with the queue
+  //! locked, so it must not call SharedOutput methods
+  using Notifier = std::function<void()>;
+
+  //! Min size of the part, which is referenced instead of copied
+  static constexpr std::size_t kMinReferencedSize = 256;
+
+  /**
+   * @brief Messages taken from the output at once
+   */
+  struct Batch {
+    /**
+     * @brief Contiguous piece of the messages data
+     */
+    struct Piece {
+      const Byte *external; //!< Referenced data or nullptr, if data is copied
+      std::size_t offset; //!< Offset of copied data in data
+      std::size_t size; //!< Size of the piece
+    };
+
+    Bytes data; //!< Copied parts
+    std::vector<Piece> pieces; //!< Pieces of all messages in order
+    std::vector<std::size_t> message_ends; //!< End offsets of the messages
+    std::size_t size = 0; //!< Total size of the messages
+    //! Owners keeping referenced data alive
+    std::vector<std::shared_ptr<const void>> owners;
+
+    /**
+     * @brief Get data of the piece
+     *
+     * @param piece Piece of this batch
+     * @return Pointer to the data
+     */
+    const Byte *GetPieceData(const Piece &piece) const;
+
+    /**
+     * @brief Remove all messages keeping allocated memory
+     */
+    void Clear();
+  };
+
+  /**
+   * @brief Construct a new SharedOutput object
+   *
+   * @param capacity Max number of queued bytes
+   * @param notifier Function waking up connection owner
+   */
+  SharedOutput(std::size_t capacity, Notifier notifier);
+
+  /**
+   * @brief Queue messages
+   * @details Thread-safe. Either all messages are queued or none of them
+   *
+   * @param parts Parts of all messages in order
+   * @param parts_per_message Number of parts of every message
+   * @param owner Owner of the parts. If set, parts of kMinReferencedSize and
+   * more are referenced and owner is kept until they are sent. Otherwise all
+   * parts are copied
+   * @return true If messages are queued
+   * @return false If there is not enough space or output is closed
+   */
+  bool Write(Span<const Span<const Byte>> parts, std::size_t parts_per_message,
+             std::shared_ptr<const void> owner = nullptr);
+
+  /**
+   * @brief Take all queued messages
+   * @details Thread-safe. Batches are swapped, so their memory is reused
+   *
+   * @param batch Empty batch, which gets the messages
+   * @return true If any message was taken
+   * @return false In other way
+   */
+  bool Take(Batch &batch);
+
+  /**
+   * @brief Get number of queued bytes, which are not taken yet
+   * @details Thread-safe
+   *
+   * @return Number of bytes
+   */
+  std::size_t GetSize() const;
+
+  /**
+   * @brief Get max number of queued bytes
+   *
+   * @return Capacity in bytes
+   */
+  std::size_t GetCapacity() const;
+
+  /**
+   * @brief Drop queued messages and refuse the next ones
+   * @details Thread-safe. Notifier is never called after return
+   */
+  void Close();
+
+ private:
+  const std::size_t capacity_; //!< Max number of queued bytes
+  mutable std::mutex mutex_; //!< Mutex to protect members below
+  Notifier notifier_; //!< Function waking up connection owner
+  Batch batch_; //!< Queued messages
+  bool closed_; //!< True, if Close() was called
+};
+
+} // namespace sock
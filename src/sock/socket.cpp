@@ -26,11 +26,18 @@ SOFTWARE.
 
 #include <cstring>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <time.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 
 #include <memory>
+#include <algorithm>
 
 #include "exception.h"
 
@@ -38,7 +45,8 @@ namespace sock {
 
 Socket::Socket(Type type):
 descriptor_(0),
-is_moved_(false) {
+is_moved_(false),
+send_times_enabled_(false) {
   int real_type = 0;
   switch (type) {
     case Type::kTcp:
@@ -59,12 +67,14 @@ is_moved_(false) {
 
 Socket::Socket(int descriptor) :
 descriptor_(descriptor),
-is_moved_(false) {
+is_moved_(false),
+send_times_enabled_(false) {
 }
 
 Socket::Socket(Socket &&other) :
 descriptor_(other.descriptor_),
-is_moved_(false) {
+is_moved_(false),
+send_times_enabled_(other.send_times_enabled_) {
   other.is_moved_ = true;
 }
 
@@ -110,23 +120,216 @@ void Socket::Send(std::string_view str) {
   }
 }
 
-void Socket::SendTo(const Bytes &bytes, const std::string &ip, int port) {
-  sockaddr_in server_addr;
-  server_addr.sin_family = AF_INET;
-  server_addr.sin_port = htons(port);
-  if (inet_pton(AF_INET, ip.c_str(), &server_addr.sin_addr) != 1) {
-    throw std::invalid_argument("Invalid ip address");
+void Socket::Send(Span<const Span<const Byte>> parts) {
+  SendParts(parts, nullptr);
+}
+
+void Socket::SendTo(Span<const Byte> bytes, const std::string &ip, int port) {
+  const Span<const Byte> parts[] = {bytes};
+  SendTo(parts, ip, port);
+}
+
+void Socket::SendTo(Span<const Span<const Byte>> parts, const std::string &ip,
+                    int port) {
+  SendTo(parts, Address(ip, port));
+}
+
+void Socket::SendTo(Span<const Span<const Byte>> parts, const Address &address) {
+  SendParts(parts, &address);
+}
+
+void Socket::SendParts(Span<const Span<const Byte>> parts, const Address *address) {
+  constexpr std::size_t kMaxParts = 8;
+  if (parts.size() > kMaxParts) {
+    throw std::invalid_argument("Too many parts of datagram");
   }
 
-  int res = sendto(descriptor_, bytes.data(), bytes.size(), MSG_CONFIRM,
-      reinterpret_cast<sockaddr *>(&server_addr), sizeof(server_addr));
+  iovec iov[kMaxParts];
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    iov[i].iov_base = const_cast<Byte *>(parts[i].data());
+    iov[i].iov_len = parts[i].size();
+  }
+
+  msghdr message = {};
+  if (address != nullptr) {
+    message.msg_name = const_cast<sockaddr *>(address->GetSockaddr());
+    message.msg_namelen = address->GetSize();
+  }
+  message.msg_iov = iov;
+  message.msg_iovlen = parts.size();
+
+  int res = sendmsg(descriptor_, &message, MSG_CONFIRM);
   if (res < 0) {
     throw SendError(strerror(errno));
   }
 }
 
+std::optional<std::size_t> Socket::TryReceive(Span<Byte> buffer) {
+  while (true) {
+    const ssize_t res = recv(descriptor_, buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (res >= 0) {
+      return res;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return std::nullopt;
+    }
+    if (errno != EINTR) {
+      throw ReadError(std::string("Can't receive datagram: ") + strerror(errno));
+    }
+  }
+}
+
+BatchSendResult Socket::SendBatch(DatagramBatch &batch, std::size_t first,
+                                  std::size_t end) {
+  // Max number of messages accepted by one sendmmsg() call
+  constexpr std::size_t kMaxMessagesPerCall = UIO_MAXIOV;
+
+  end = std::min(end, batch.Size());
+  batch.LinkParts(first, end, send_times_enabled_);
+  while (first < end) {
+    const std::size_t count = std::min(end - first, kMaxMessagesPerCall);
+    const int res = sendmmsg(descriptor_, batch.messages_.data() + first, count,
+                             MSG_DONTWAIT);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return {first, errno};
+    }
+
+    first += res;
+  }
+
+  return {first, 0};
+}
+
+bool Socket::SupportsSegmentation() const {
+  int segment_size = 0;
+  socklen_t size = sizeof(segment_size);
+  return getsockopt(descriptor_, IPPROTO_UDP, UDP_SEGMENT, &segment_size, &size) == 0;
+}
+
+std::optional<std::size_t> Socket::GetQueuedSendBytes() const {
+  int queued = 0;
+  if (ioctl(descriptor_, SIOCOUTQ, &queued) != 0) {
+    return std::nullopt;
+  }
+
+  return static_cast<std::size_t>(queued);
+}
+
+std::optional<std::size_t> Socket::GetSendBufferSize() const {
+  int buffer_size = 0;
+  socklen_t size = sizeof(buffer_size);
+  if (getsockopt(descriptor_, SOL_SOCKET, SO_SNDBUF, &buffer_size, &size) != 0) {
+    return std::nullopt;
+  }
+
+  return static_cast<std::size_t>(buffer_size);
+}
+
+bool Socket::EnableSendTimes() {
+  sock_txtime config = {};
+  config.clockid = CLOCK_MONOTONIC;
+  send_times_enabled_ = (setsockopt(descriptor_, SOL_SOCKET, SO_TXTIME,
+                                    &config, sizeof(config)) == 0 &&
+                         ProbeSendTime());
+  return send_times_enabled_;
+}
+
+bool Socket::ProbeSendTime() {
+  // Empty datagram is sent to the own port, so nobody else receives it
+  sockaddr_in address = {};
+  socklen_t address_size = sizeof(address);
+  if (getsockname(descriptor_, reinterpret_cast<sockaddr *>(&address),
+                  &address_size) != 0) {
+    return false;
+  }
+  if (address.sin_addr.s_addr == htonl(INADDR_ANY)) {
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+
+  timespec now = {};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  const uint64_t send_time = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 +
+      static_cast<uint64_t>(now.tv_nsec);
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(send_time))] = {};
+  msghdr header = {};
+  header.msg_name = &address;
+  header.msg_namelen = address_size;
+  header.msg_control = control;
+  header.msg_controllen = sizeof(control);
+  cmsghdr *control_header = CMSG_FIRSTHDR(&header);
+  control_header->cmsg_level = SOL_SOCKET;
+  control_header->cmsg_type = SCM_TXTIME;
+  control_header->cmsg_len = CMSG_LEN(sizeof(send_time));
+  std::memcpy(CMSG_DATA(control_header), &send_time, sizeof(send_time));
+
+  // Kernels, which accept the option but not the times, fail with EINVAL
+  return sendmsg(descriptor_, &header, 0) == 0;
+}
+
+void Socket::SetMulticastOptions(const MulticastOptions &options) {
+  const int ttl = options.ttl;
+  if (setsockopt(descriptor_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0) {
+    throw SocketException(std::string("Can't set multicast TTL: ") + strerror(errno));
+  }
+
+  if (options.interface_ip.empty()) {
+    return;
+  }
+
+  in_addr interface_address = {};
+  if (inet_pton(AF_INET, options.interface_ip.c_str(), &interface_address) != 1 ||
+      setsockopt(descriptor_, IPPROTO_IP, IP_MULTICAST_IF, &interface_address,
+                 sizeof(interface_address)) < 0) {
+    throw SocketException("Can't send multicast from " + options.interface_ip);
+  }
+}
+
+bool Socket::EnableZeroCopy() {
+  const int enable = 1;
+  return setsockopt(descriptor_, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+}
+
+std::optional<ZeroCopyCompletion> Socket::ReceiveZeroCopyCompletion() {
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err) +
+                                           sizeof(sockaddr_in))];
+  msghdr message = {};
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  while (recvmsg(descriptor_, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return std::nullopt;
+    }
+    if (errno != EINTR) {
+      throw ReadError(std::string("Can't read error queue: ") + strerror(errno));
+    }
+  }
+
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&message, cmsg)) {
+    if (cmsg->cmsg_level != SOL_IP || cmsg->cmsg_type != IP_RECVERR) {
+      continue;
+    }
+
+    sock_extended_err error;
+    std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+    if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno != 0) {
+      throw ReadError(strerror(error.ee_errno));
+    }
+    return ZeroCopyCompletion{error.ee_info, error.ee_data,
+                              (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0};
+  }
+
+  throw ReadError("Unexpected message in error queue");
+}
+
 Socket &Socket::operator=(Socket &&other) {
   descriptor_ = other.descriptor_;
+  send_times_enabled_ = other.send_times_enabled_;
   other.is_moved_ = true;
 
   return *this;
@@ -24,12 +24,26 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+#include <sys/socket.h>
+
 #include <string>
 #include <string_view>
+#include <optional>
 #include <sstream>
 #include <ostream>
 
 #include "byte.h"
+#include "span.h"
+#include "address.h"
+#include "datagram_batch.h"
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60 // Since Linux 4.14
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
 
 namespace sock {
 
@@ -41,6 +55,26 @@ enum class Type {
   kUdp
 };
 
+/**
+ * @brief Options of sent multicast datagrams
+ */
+struct MulticastOptions {
+  //! Ip address of the interface to send from. Empty for the default route
+  std::string interface_ip;
+  int ttl; //!< Time to live. 1 keeps datagrams in the local network
+};
+
+/**
+ * @brief Notification about completed zero-copy sends
+ * @details Sends are numbered from 0 in order of successful calls with
+ * MSG_ZEROCOPY
+ */
+struct ZeroCopyCompletion {
+  uint32_t first; //!< Number of the first completed send
+  uint32_t last; //!< Number of the last completed send
+  bool copied; //!< True, if kernel had to copy the data anyway
+};
+
 /**
  * @brief Linux socket wrapper
  */
@@ -92,6 +126,13 @@ class Socket {
    */
   void Send(std::string_view str);
 
+  /**
+   * @brief Send datagram gathered from several parts through connected socket
+   *
+   * @param parts Parts of the datagram in order
+   */
+  void Send(Span<const Span<const Byte>> parts);
+
   /**
    * @brief Send bytes
    *
@@ -99,7 +140,108 @@ class Socket {
    * @param ip Destination ip
    * @param ip Destination port
    */
-  void SendTo(const Bytes &bytes, const std::string &ip, int port);
+  void SendTo(Span<const Byte> bytes, const std::string &ip, int port);
+
+  /**
+   * @brief Send datagram gathered from several parts without copying them
+   *
+   * @param parts Parts of the datagram in order
+   * @param ip Destination ip
+   * @param ip Destination port
+   */
+  void SendTo(Span<const Span<const Byte>> parts, const std::string &ip, int port);
+
+  /**
+   * @brief Send datagram gathered from several parts without copying them
+   *
+   * @param parts Parts of the datagram in order
+   * @param address Resolved destination
+   */
+  void SendTo(Span<const Span<const Byte>> parts, const Address &address);
+
+  /**
+   * @brief Receive datagram without waiting
+   * @throws ReadError if receiving failed
+   *
+   * @param buffer Destination. Longer datagrams are truncated
+   * @return Size of the received datagram, if there was one
+   */
+  std::optional<std::size_t> TryReceive(Span<Byte> buffer);
+
+  /**
+   * @brief Send datagrams of the batch with sendmmsg()
+   * @details Stops on the first datagram, that can't be sent. Caller can
+   * retry from it or skip it. Never blocks: full send buffer stops sending
+   * with EAGAIN
+   *
+   * @param batch Datagrams to send
+   * @param first Index of the first datagram to send
+   * @param end Index after the last datagram to send. Batch end if greater
+   * @return Index of the first not sent datagram and error, that stopped sending
+   */
+  BatchSendResult SendBatch(DatagramBatch &batch, std::size_t first = 0,
+                            std::size_t end = SIZE_MAX);
+
+  /**
+   * @brief Check if kernel can split datagrams of this socket (UDP GSO)
+   *
+   * @return true if segmented datagrams can be added to the batch
+   */
+  bool SupportsSegmentation() const;
+
+  /**
+   * @brief Get number of bytes in the kernel send queue (SIOCOUTQ)
+   * @details For UDP these are datagrams, which are not sent by the device
+   * yet. For TCP these are bytes, which are not acknowledged by the peer yet
+   *
+   * @return Number of bytes if it's known
+   */
+  std::optional<std::size_t> GetQueuedSendBytes() const;
+
+  /**
+   * @brief Get size of the kernel send buffer (SO_SNDBUF)
+   * @details Kernel accounts queued data with overhead, so the size is
+   * compared with GetQueuedSendBytes() as is
+   *
+   * @return Size in bytes if it's known
+   */
+  std::optional<std::size_t> GetSendBufferSize() const;
+
+  /**
+   * @brief Let kernel hold datagrams until their send times (SO_TXTIME)
+   * @details Times are of CLOCK_MONOTONIC, so they are honored only by fq
+   * qdisc. etf needs CLOCK_TAI and drops such datagrams, others send them at
+   * once. Support is checked by sending an empty datagram with
+   * send time to the own port of the socket
+   *
+   * @return true if send times of the batch datagrams are passed to kernel
+   */
+  bool EnableSendTimes();
+
+  /**
+   * @brief Set options of sent multicast datagrams
+   * @throws SocketException if options can't be set
+   *
+   * @param options Multicast options
+   */
+  void SetMulticastOptions(const MulticastOptions &options);
+
+  /**
+   * @brief Let sends with MSG_ZEROCOPY flag use user pages without copying
+   * @details Pages must not be modified until completion is received with
+   * ReceiveZeroCopyCompletion()
+   *
+   * @return true if SO_ZEROCOPY is supported
+   */
+  bool EnableZeroCopy();
+
+  /**
+   * @brief Read notification about completed zero-copy sends from the error queue
+   * @throws ReadError if the queue holds a real error
+   *
+   * @return Notification if there was one
+   */
+  std::optional<ZeroCopyCompletion> ReceiveZeroCopyCompletion();
 
   Socket &operator=(Socket &&other);
 
@@ -113,7 +255,25 @@ class Socket {
   friend Socket &operator<<(Socket &socket, std::ostream &(*f)(std::ostream &));
 
   bool is_moved_; //!< True, if Socket was moved
+  bool send_times_enabled_; //!< True, if SO_TXTIME is set
   std::ostringstream ss_buffer_; //!< Buffer for operator<<
+
+  /**
+   * @brief Send datagram gathered from several parts without copying them
+   * @throws SendError if sending failed
+   *
+   * @param parts Parts of the datagram in order
+   * @param address Destination or nullptr for connected socket
+   */
+  void SendParts(Span<const Span<const Byte>> parts, const Address *address);
+
+  /**
+   * @brief Check that kernel accepts send times of the datagrams
+   * @details SO_TXTIME must be already set
+   *
+   * @return true if datagram with send time was sent
+   */
+  bool ProbeSendTime();
 };
 
 /**
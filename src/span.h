@@ -0,0 +1,121 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Non-owning view of a contiguous sequence of objects
+ * @details Minimal stand-in for C++20 std::span with dynamic extent
+ *
+ * @tparam T Type of the objects, may be const
+ */
+template <typename T>
+class Span {
+ public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  constexpr Span() noexcept :
+  data_(nullptr),
+  size_(0) {}
+
+  constexpr Span(T *data, std::size_t size) noexcept :
+  data_(data),
+  size_(size) {}
+
+  /**
+   * @brief Construct a new Span object viewing the whole array
+   *
+   * @param array C array
+   */
+  template <std::size_t N>
+  constexpr Span(T (&array)[N]) noexcept :
+  data_(array),
+  size_(N) {}
+
+  /**
+   * @brief Construct a new Span object viewing the whole container
+   *
+   * @param container Container with contiguous storage, e.g. std::vector
+   */
+  template <typename Container,
+            typename = std::enable_if_t<std::is_convertible_v<
+                decltype(std::declval<Container &>().data()), T *>>>
+  constexpr Span(Container &container) noexcept :
+  data_(container.data()),
+  size_(container.size()) {}
+
+  /**
+   * @brief Allow conversion from Span<U> to Span<const U>
+   */
+  template <typename U,
+            typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+  constexpr Span(const Span<U> &other) noexcept :
+  data_(other.data()),
+  size_(other.size()) {}
+
+  constexpr T *data() const noexcept {
+    return data_;
+  }
+
+  constexpr std::size_t size() const noexcept {
+    return size_;
+  }
+
+  constexpr bool empty() const noexcept {
+    return (size_ == 0);
+  }
+
+  constexpr T *begin() const noexcept {
+    return data_;
+  }
+
+  constexpr T *end() const noexcept {
+    return data_ + size_;
+  }
+
+  constexpr T &operator[](std::size_t index) const noexcept {
+    return data_[index];
+  }
+
+  /**
+   * @brief Get view of the part of this sequence
+   *
+   * @param offset Index of the first object. Must not exceed size()
+   * @param count Number of objects. Clamped to the end of the sequence
+   * @return Span with the part
+   */
+  constexpr Span subspan(std::size_t offset, std::size_t count = npos) const noexcept {
+    const std::size_t rest = size_ - offset;
+    return {data_ + offset, (count < rest ? count : rest)};
+  }
+
+ private:
+  T *data_; //!< Pointer to the first object
+  std::size_t size_; //!< Number of objects
+};
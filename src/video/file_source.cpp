@@ -0,0 +1,296 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "file_source.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string_view>
+
+namespace {
+
+const std::string_view kY4mSignature = "YUV4MPEG2 ";
+const std::string_view kY4mFrameSignature = "FRAME";
+
+/**
+ * @brief Clamp value to [0, 255] range
+ *
+ * @param value Value to be clamped
+ * @return Clamped value
+ */
+Byte Clamp(const int value) {
+  return static_cast<Byte>(std::clamp(value, 0, 255));
+}
+
+/**
+ * @brief Convert one pixel from BT.601 YCbCr to RGB
+ *
+ * @param y Luma
+ * @param u Blue-difference chroma
+ * @param v Red-difference chroma
+ * @param rgb Destination of 3 bytes
+ */
+void YuvToRgb(const int y, const int u, const int v, Byte *rgb) {
+  const int c = 298 * (y - 16) + 128;
+  const int d = u - 128;
+  const int e = v - 128;
+
+  rgb[0] = Clamp((c + 409 * e) >> 8);
+  rgb[1] = Clamp((c - 100 * d - 208 * e) >> 8);
+  rgb[2] = Clamp((c + 516 * d) >> 8);
+}
+
+/**
+ * @brief Parse unsigned number
+ *
+ * @param str String starting with number. Will be moved behind the number
+ * @return Parsed number
+ */
+unsigned int ParseNumber(std::string_view &str) {
+  unsigned int number = 0;
+  std::size_t i = 0;
+  for (; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i) {
+    number = number * 10 + (str[i] - '0');
+  }
+
+  str.remove_prefix(i);
+  return number;
+}
+
+} // namespace
+
+namespace video {
+
+FileSource::FileSource(const std::string &path) :
+data_(nullptr),
+data_size_(0),
+format_(Format::kYuv420),
+width_(0),
+height_(0),
+frame_rate_(0),
+frames_(),
+next_frame_(0) {
+  Map(path);
+  try {
+    IndexY4m();
+  } catch (...) {
+    munmap(const_cast<Byte *>(data_), data_size_);
+    throw;
+  }
+}
+
+FileSource::FileSource(const std::string &path, const unsigned int width,
+                       const unsigned int height,
+                       const unsigned int frame_rate) :
+data_(nullptr),
+data_size_(0),
+format_(Format::kRgb),
+width_(width),
+height_(height),
+frame_rate_(frame_rate),
+frames_(),
+next_frame_(0) {
+  if (width_ == 0 || height_ == 0 || frame_rate_ == 0) {
+    throw FrameSourceError("File source parameters must be positive");
+  }
+
+  Map(path);
+  try {
+    IndexRgb();
+  } catch (...) {
+    munmap(const_cast<Byte *>(data_), data_size_);
+    throw;
+  }
+}
+
+FileSource::~FileSource() {
+  munmap(const_cast<Byte *>(data_), data_size_);
+}
+
+unsigned int FileSource::GetWidth() const {
+  return width_;
+}
+
+unsigned int FileSource::GetHeight() const {
+  return height_;
+}
+
+unsigned int FileSource::GetFrameRate() const {
+  return frame_rate_;
+}
+
+void FileSource::Grab(Byte *buffer) {
+  WaitForNextFrame();
+
+  const Byte *frame = frames_[next_frame_];
+  next_frame_ = (next_frame_ + 1) % frames_.size();
+
+  if (format_ == Format::kRgb) {
+    std::memcpy(buffer, frame, GetFrameSize());
+    return;
+  }
+
+  const std::size_t luma_size = static_cast<std::size_t>(width_) * height_;
+  const bool subsampled = (format_ == Format::kYuv420);
+  const unsigned int chroma_width = (subsampled ? (width_ + 1) / 2 : width_);
+  const unsigned int chroma_height = (subsampled ? (height_ + 1) / 2 : height_);
+  const Byte *y_plane = frame;
+  const Byte *u_plane = y_plane + luma_size;
+  const Byte *v_plane = u_plane + static_cast<std::size_t>(chroma_width) * chroma_height;
+
+  for (unsigned int row = 0; row < height_; ++row) {
+    const unsigned int chroma_row = (subsampled ? row / 2 : row);
+    for (unsigned int col = 0; col < width_; ++col) {
+      const std::size_t chroma_index = static_cast<std::size_t>(chroma_row) * chroma_width +
+          (subsampled ? col / 2 : col);
+      YuvToRgb(y_plane[static_cast<std::size_t>(row) * width_ + col],
+               u_plane[chroma_index], v_plane[chroma_index], buffer);
+      buffer += 3;
+    }
+  }
+}
+
+void FileSource::Map(const std::string &path) {
+  int descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    throw FrameSourceError("Can't open " + path + ": " + strerror(errno));
+  }
+
+  struct stat file_stat;
+  if (fstat(descriptor, &file_stat) < 0 || file_stat.st_size == 0) {
+    close(descriptor);
+    throw FrameSourceError("Can't get size of " + path);
+  }
+
+  void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+                      descriptor, 0);
+  close(descriptor);
+  if (mapped == MAP_FAILED) {
+    throw FrameSourceError("Can't map " + path + ": " + strerror(errno));
+  }
+
+  // Frames are read one after another
+  madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+
+  data_ = static_cast<const Byte *>(mapped);
+  data_size_ = file_stat.st_size;
+}
+
+void FileSource::IndexY4m() {
+  const std::string_view content(reinterpret_cast<const char *>(data_), data_size_);
+  if (content.substr(0, kY4mSignature.size()) != kY4mSignature) {
+    throw FrameSourceError("File is not in Y4M format");
+  }
+
+  std::size_t header_end = content.find('\n');
+  if (header_end == std::string_view::npos) {
+    throw FrameSourceError("Y4M header is not terminated");
+  }
+
+  std::string_view header = content.substr(kY4mSignature.size(),
+                                           header_end - kY4mSignature.size());
+  unsigned int rate_numerator = 0;
+  unsigned int rate_denominator = 1;
+  while (!header.empty()) {
+    const std::size_t token_end = std::min(header.find(' '), header.size());
+    std::string_view token = header.substr(0, token_end);
+    header.remove_prefix(std::min(token_end + 1, header.size()));
+    if (token.empty()) {
+      continue;
+    }
+
+    const char tag = token.front();
+    token.remove_prefix(1);
+    switch (tag) {
+      case 'W':
+        width_ = ParseNumber(token);
+        break;
+      case 'H':
+        height_ = ParseNumber(token);
+        break;
+      case 'F':
+        rate_numerator = ParseNumber(token);
+        token.remove_prefix(std::min<std::size_t>(1, token.size()));
+        rate_denominator = ParseNumber(token);
+        break;
+      case 'C':
+        if (token.substr(0, 3) == "444") {
+          format_ = Format::kYuv444;
+        } else if (token.substr(0, 3) != "420") {
+          throw FrameSourceError("Unsupported Y4M colorspace C" + std::string(token));
+        }
+        break;
+      default:
+        break; // Interlacing, aspect ratio and comments aren't interesting
+    }
+  }
+
+  if (width_ == 0 || height_ == 0 || rate_numerator == 0 || rate_denominator == 0) {
+    throw FrameSourceError("Y4M header lacks dimensions or frame rate");
+  }
+  frame_rate_ = std::max(1u, rate_numerator / rate_denominator);
+
+  const std::size_t luma_size = static_cast<std::size_t>(width_) * height_;
+  const std::size_t chroma_size = (format_ == Format::kYuv420 ?
+      static_cast<std::size_t>((width_ + 1) / 2) * ((height_ + 1) / 2) : luma_size);
+  const std::size_t frame_size = luma_size + 2 * chroma_size;
+
+  std::size_t pos = header_end + 1;
+  while (pos < content.size()) {
+    if (content.substr(pos, kY4mFrameSignature.size()) != kY4mFrameSignature) {
+      throw FrameSourceError("Broken Y4M frame header");
+    }
+
+    const std::size_t frame_header_end = content.find('\n', pos);
+    if (frame_header_end == std::string_view::npos ||
+        frame_header_end + 1 + frame_size > content.size()) {
+      break; // Truncated last frame
+    }
+
+    frames_.push_back(data_ + frame_header_end + 1);
+    pos = frame_header_end + 1 + frame_size;
+  }
+
+  if (frames_.empty()) {
+    throw FrameSourceError("Y4M file doesn't contain any frames");
+  }
+}
+
+void FileSource::IndexRgb() {
+  const std::size_t frame_size = GetFrameSize();
+  for (std::size_t pos = 0; pos + frame_size <= data_size_; pos += frame_size) {
+    frames_.push_back(data_ + pos);
+  }
+
+  if (frames_.empty()) {
+    throw FrameSourceError("File is smaller than one frame");
+  }
+}
+
+} // namespace video
@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "frame_source.h"
+
+namespace video {
+
+/**
+ * @brief Frame source playing frames from memory-mapped file in a loop
+ * @details Supports two formats:
+ * 1. YUV4MPEG2 (Y4M) with 4:2:0 or 4:4:4 chroma subsampling;
+ * 2. Raw packed RGB frames one after another. Dimensions should be provided
+ */
+class FileSource : public FrameSource {
+ public:
+  /**
+   * @brief Construct a new FileSource object from Y4M file
+   * @details Dimensions and frame rate are taken from the file header
+   *
+   * @param path Path to the Y4M file
+   */
+  explicit FileSource(const std::string &path);
+
+  /**
+   * @brief Construct a new FileSource object from raw RGB file
+   *
+   * @param path Path to the raw file
+   * @param width Frame width
+   * @param height Frame height
+   * @param frame_rate Number of frames played per second
+   */
+  FileSource(const std::string &path, unsigned int width, unsigned int height,
+             unsigned int frame_rate);
+
+  FileSource(const FileSource &) = delete;
+  FileSource &operator=(const FileSource &) = delete;
+
+  ~FileSource() override;
+
+  unsigned int GetWidth() const override;
+
+  unsigned int GetHeight() const override;
+
+  unsigned int GetFrameRate() const override;
+
+  void Grab(Byte *buffer) override;
+
+ private:
+  /**
+   * @brief Layout of pixels of the frames in the file
+   */
+  enum class Format {
+    kRgb,
+    kYuv420,
+    kYuv444
+  };
+
+  const Byte *data_; //!< Mapped file content
+  std::size_t data_size_; //!< Size of the mapped file
+  Format format_; //!< Frames format
+  unsigned int width_; //!< Frame width
+  unsigned int height_; //!< Frame height
+  unsigned int frame_rate_; //!< Frames per second
+  std::vector<const Byte *> frames_; //!< Pointers to the first byte of every frame
+  std::size_t next_frame_; //!< Index of the frame which will be played next
+
+  /**
+   * @brief Map file into memory
+   *
+   * @param path Path to the file
+   */
+  void Map(const std::string &path);
+
+  /**
+   * @brief Parse Y4M stream header and index all frames
+   */
+  void IndexY4m();
+
+  /**
+   * @brief Index all frames of raw RGB file
+   */
+  void IndexRgb();
+};
+
+} // namespace video
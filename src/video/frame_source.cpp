@@ -0,0 +1,56 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "frame_source.h"
+
+#include <thread>
+
+namespace video {
+
+FrameSourceError::FrameSourceError(std::string_view message) :
+std::runtime_error(message.data()) {}
+
+FrameSource::~FrameSource() {}
+
+std::size_t FrameSource::GetFrameSize() const {
+  const std::size_t kComponentsNumber = 3; // RGB
+  return static_cast<std::size_t>(GetWidth()) * GetHeight() * kComponentsNumber;
+}
+
+void FrameSource::WaitForNextFrame() {
+  const auto now = std::chrono::steady_clock::now();
+  const auto frame_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::seconds(1)) / GetFrameRate();
+
+  if (next_frame_time_ < now) {
+    // First frame or we are late. Don't try to catch up with a burst of frames
+    next_frame_time_ = now;
+  } else {
+    std::this_thread::sleep_until(next_frame_time_);
+  }
+
+  next_frame_time_ += frame_period;
+}
+
+} // namespace video
@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <stdexcept>
+#include <string_view>
+#include <chrono>
+
+#include "byte.h"
+
+namespace video {
+
+/**
+ * @brief Exception indicating that frame source can't be opened or read
+ */
+class FrameSourceError : public std::runtime_error {
+ public:
+  FrameSourceError(std::string_view message);
+};
+
+/**
+ * @brief Interface for every source of raw video frames
+ * @details Frames are always produced as packed 8-bit RGB, so the rest of the
+ * pipeline does not care whether they came from the camera or from somewhere else
+ */
+class FrameSource {
+ public:
+  virtual ~FrameSource();
+
+  /**
+   * @brief Get width of the produced frames
+   *
+   * @return Width in pixels
+   */
+  virtual unsigned int GetWidth() const = 0;
+
+  /**
+   * @brief Get height of the produced frames
+   *
+   * @return Height in pixels
+   */
+  virtual unsigned int GetHeight() const = 0;
+
+  /**
+   * @brief Get number of frames produced per second
+   *
+   * @return Frame rate
+   */
+  virtual unsigned int GetFrameRate() const = 0;
+
+  /**
+   * @brief Get size of one RGB frame in bytes
+   *
+   * @return Size of the buffer required by Grab()
+   */
+  std::size_t GetFrameSize() const;
+
+  /**
+   * @brief Wait for the next frame and write it into buffer
+   *
+   * @param buffer Destination of at least GetFrameSize() bytes
+   */
+  virtual void Grab(Byte *buffer) = 0;
+
+ protected:
+  /**
+   * @brief Sleep until the moment of the next frame according to frame rate
+   * @details Used by sources which aren't paced by hardware
+   */
+  void WaitForNextFrame();
+
+ private:
+  //! Moment when the next frame should be produced
+  std::chrono::steady_clock::time_point next_frame_time_;
+};
+
+} // namespace video
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "jpeg_encoder.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+
+namespace video {
+
+JpegEncoder::JpegEncoder(const unsigned int width, const unsigned int height,
+                         const int quality) :
+quality_(quality),
+cinfo_(),
+error_manager_(),
+buffer_(nullptr),
+buffer_size_(0) {
+  cinfo_.err = jpeg_std_error(&error_manager_);
+  jpeg_create_compress(&cinfo_);
+
+  cinfo_.image_width = width;
+  cinfo_.image_height = height;
+  cinfo_.input_components = 3;		// # of color components per pixel
+  cinfo_.in_color_space = JCS_RGB; 	// colorspace of input image
+
+  jpeg_set_defaults(&cinfo_);
+  jpeg_set_quality(&cinfo_, quality_, TRUE /* limit to baseline-JPEG values */);
+}
+
+JpegEncoder::~JpegEncoder() {
+  jpeg_destroy_compress(&cinfo_);
+  free(buffer_);
+}
+
+int JpegEncoder::GetQuality() const {
+  return quality_;
+}
+
+void JpegEncoder::Encode(const Byte *raw_image, Bytes &jpeg) {
+  unsigned char *buffer = buffer_;
+  unsigned long buffer_size = buffer_size_;
+  jpeg_mem_dest(&cinfo_, &buffer, &buffer_size);
+
+  jpeg_start_compress(&cinfo_, TRUE);
+
+  const std::size_t row_stride = static_cast<std::size_t>(cinfo_.image_width) * 3;
+  while (cinfo_.next_scanline < cinfo_.image_height) {
+    JSAMPROW row_pointer[1] = {
+        const_cast<JSAMPLE *>(raw_image + cinfo_.next_scanline * row_stride)
+    };
+    (void) jpeg_write_scanlines(&cinfo_, row_pointer, 1);
+  }
+
+  jpeg_finish_compress(&cinfo_);
+
+  // libjpeg allocates a new buffer if image didn't fit into the old one
+  if (buffer != buffer_) {
+    free(buffer_);
+    buffer_ = buffer;
+  }
+  buffer_size_ = std::max(buffer_size_, buffer_size);
+
+  jpeg.assign(buffer, buffer + buffer_size);
+}
+
+} // namespace video
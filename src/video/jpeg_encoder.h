@@ -0,0 +1,77 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <jpeglib.h>
+
+#include "byte.h"
+
+namespace video {
+
+/**
+ * @brief Encoder of raw RGB frames to JPEG
+ * @details Compressor and output buffer are reused between frames
+ */
+class JpegEncoder {
+ public:
+  /**
+   * @brief Construct a new JpegEncoder object
+   *
+   * @param width Width of the encoded frames
+   * @param height Height of the encoded frames
+   * @param quality Quality of resulting images in [0, 100] range
+   */
+  JpegEncoder(unsigned int width, unsigned int height, int quality);
+
+  JpegEncoder(const JpegEncoder &) = delete;
+  JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+  ~JpegEncoder();
+
+  /**
+   * @brief Get quality of resulting images
+   *
+   * @return Quality in [0, 100] range
+   */
+  int GetQuality() const;
+
+  /**
+   * @brief Encode raw RGB frame to JPEG
+   *
+   * @param raw_image Frame of width * height * 3 bytes
+   * @param jpeg Destination of the encoded image. Its memory is reused
+   */
+  void Encode(const Byte *raw_image, Bytes &jpeg);
+
+ private:
+  const int quality_; //!< Quality of resulting images
+  jpeg_compress_struct cinfo_; //!< Compressor
+  jpeg_error_mgr error_manager_; //!< Compressor error manager
+  unsigned char *buffer_; //!< Output buffer, allocated with malloc()
+  unsigned long buffer_size_; //!< Size of buffer_
+};
+
+} // namespace video
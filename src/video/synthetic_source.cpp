@@ -0,0 +1,146 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "synthetic_source.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+//! Number of bytes processed by one vector operation
+const std::size_t kVectorSize = 16;
+
+//! Pattern shift per frame
+const uint32_t kPixelsPerFrame = 4;
+
+/**
+ * @brief Get next pseudo-random value using xorshift algorithm
+ *
+ * @param state Generator state, will be updated
+ * @return Pseudo-random value
+ */
+uint32_t NextNoise(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/**
+ * @brief Fill one row with gradient where every next byte is greater by one
+ * @details Noise is added to every group of 16 bytes
+ *
+ * @param row Row to be filled
+ * @param size Size of the row in bytes
+ * @param start Value of the first byte
+ * @param noise 16 bytes of noise
+ */
+void FillRow(Byte *row, const std::size_t size, const uint8_t start,
+             const Byte (&noise)[kVectorSize]) {
+  std::size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i kStep = _mm_set1_epi8(static_cast<char>(kVectorSize));
+  const __m128i noise_vec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(noise));
+  __m128i gradient = _mm_add_epi8(
+      _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+      _mm_set1_epi8(static_cast<char>(start)));
+  for (; i + kVectorSize <= size; i += kVectorSize) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i),
+                     _mm_add_epi8(gradient, noise_vec));
+    gradient = _mm_add_epi8(gradient, kStep);
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t kStep = vdupq_n_u8(kVectorSize);
+  const uint8x16_t noise_vec = vld1q_u8(noise);
+  const uint8_t kIndexes[kVectorSize] = {0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15};
+  uint8x16_t gradient = vaddq_u8(vld1q_u8(kIndexes), vdupq_n_u8(start));
+  for (; i + kVectorSize <= size; i += kVectorSize) {
+    vst1q_u8(row + i, vaddq_u8(gradient, noise_vec));
+    gradient = vaddq_u8(gradient, kStep);
+  }
+#endif
+
+  for (; i < size; ++i) {
+    row[i] = static_cast<Byte>(start + i + noise[i % kVectorSize]);
+  }
+}
+
+} // namespace
+
+namespace video {
+
+SyntheticSource::SyntheticSource(const unsigned int width,
+                                 const unsigned int height,
+                                 const unsigned int frame_rate) :
+width_(width),
+height_(height),
+frame_rate_(frame_rate),
+frame_counter_(0),
+noise_state_(0x9E3779B9) {
+  if (width_ == 0 || height_ == 0 || frame_rate_ == 0) {
+    throw FrameSourceError("Synthetic source parameters must be positive");
+  }
+}
+
+unsigned int SyntheticSource::GetWidth() const {
+  return width_;
+}
+
+unsigned int SyntheticSource::GetHeight() const {
+  return height_;
+}
+
+unsigned int SyntheticSource::GetFrameRate() const {
+  return frame_rate_;
+}
+
+void SyntheticSource::Grab(Byte *buffer) {
+  WaitForNextFrame();
+
+  const std::size_t row_size = static_cast<std::size_t>(width_) * 3;
+  const uint32_t phase = frame_counter_ * kPixelsPerFrame;
+  for (unsigned int y = 0; y < height_; ++y) {
+    Byte noise[kVectorSize];
+    for (std::size_t i = 0; i < kVectorSize; i += sizeof(uint32_t)) {
+      // Only low bits are used to keep the gradient visible
+      const uint32_t value = NextNoise(noise_state_) & 0x0F0F0F0F;
+      std::memcpy(noise + i, &value, sizeof(value));
+    }
+
+    FillRow(buffer + y * row_size, row_size,
+            static_cast<uint8_t>(y + phase), noise);
+  }
+
+  ++frame_counter_;
+}
+
+} // namespace video
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "frame_source.h"
+
+namespace video {
+
+/**
+ * @brief Frame source generating moving gradient with noise
+ * @details Doesn't need any hardware, so it can be used for benchmarking and
+ * load testing on any machine
+ */
+class SyntheticSource : public FrameSource {
+ public:
+  /**
+   * @brief Construct a new SyntheticSource object
+   *
+   * @param width Width of generated frames
+   * @param height Height of generated frames
+   * @param frame_rate Number of frames generated per second
+   */
+  SyntheticSource(unsigned int width, unsigned int height,
+                  unsigned int frame_rate);
+
+  unsigned int GetWidth() const override;
+
+  unsigned int GetHeight() const override;
+
+  unsigned int GetFrameRate() const override;
+
+  void Grab(Byte *buffer) override;
+
+ private:
+  const unsigned int width_; //!< Frame width
+  const unsigned int height_; //!< Frame height
+  const unsigned int frame_rate_; //!< Frames per second
+  uint32_t frame_counter_; //!< Number of generated frames. Moves the pattern
+  uint32_t noise_state_; //!< State of the noise generator
+};
+
+} // namespace video
@@ -0,0 +1,250 @@
+/*
+MIT License
+
+Copyright (c) 2021 Polyakov Daniil Alexandrovich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <optional>
+#include <iostream>
+
+#include "byte.h"
+#include "span.h"
+#include "rtcp/packet.h"
+#include "pipeline/pipeline.h"
+#include "pipeline/frame_packetizer.h"
+#include "pipeline/rtp_egress.h"
+#include "pipeline/rtp_sink.h"
+#include "pipeline/rtp_streamer.h"
+
+namespace {
+
+//! Number of heap allocations since the program start
+std::atomic<std::size_t> allocations(0);
+
+//! Number of the last frames, which packets are kept for retransmission
+const std::size_t kHistoryFrames = 3;
+//! Frames in the pool: history ones and the one being sent
+const std::size_t kPoolSize = kHistoryFrames + 1;
+//! Frames sent before counting, so all buffers reach their final size
+const std::size_t kWarmUpFrames = 5 * kPoolSize;
+//! Frames sent while counting allocations
+const std::size_t kMeasuredFrames = 1000;
+//! Every this frame the client reports lost packets
+const std::size_t kNackInterval = 10;
+//! Number of paced sessions sharing the egress, so their datagrams interleave
+const std::size_t kPacedSessions = 3;
+//! Ports of the paced sessions clients. Nobody listens on them
+const int kFirstClientPort = 6994;
+
+/**
+ * @brief Sink counting packets instead of sending them
+ */
+class CountingSink : public pipeline::RtpSink {
+ public:
+  std::size_t packets = 0; //!< Number of queued packets
+  uint16_t last_sequence_number = 0; //!< Sequence number of the last packet
+
+  std::optional<pipeline::QueueOccupancy> GetQueueOccupancy() const override {
+    return std::nullopt;
+  }
+
+  bool QueueFrame(const pipeline::EncodedFramePtr &,
+                  Span<const Span<const Byte>> parts, std::size_t,
+                  std::chrono::nanoseconds) override {
+    // Parts come in header and payload pairs
+    packets += parts.size() / 2;
+    const Span<const Byte> header = parts[parts.size() - 2];
+    last_sequence_number = static_cast<uint16_t>((header[2] << 8) | header[3]);
+    return true;
+  }
+
+  bool Flush() override {
+    return true;
+  }
+};
+
+/**
+ * @brief Build frame with JPEG markers around pseudo-random entropy coded data
+ *
+ * @param data_size Size of the entropy coded data
+ * @return Frame
+ */
+pipeline::EncodedFramePtr BuildFrame(const std::size_t data_size) {
+  auto frame = std::make_shared<pipeline::EncodedFrame>();
+  frame->jpeg = {0xFF, 0xD8, 0xFF, 0xDA, 0x00, 0x0C};
+  frame->jpeg.resize(frame->jpeg.size() + 10);
+  for (std::size_t i = 0; i < data_size; ++i) {
+    // Data never contains markers
+    frame->jpeg.push_back(static_cast<Byte>((i * 31) % 0xFF));
+  }
+  frame->jpeg.push_back(0xFF);
+  frame->jpeg.push_back(0xD9);
+  frame->width = 1280;
+  frame->height = 960;
+  frame->quality = 70;
+  frame->number = 0;
+
+  return frame;
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (void *ptr = std::malloc(size != 0 ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+/**
+ * @brief Check that sending frames, including retransmissions on NACK,
+ * doesn't allocate once buffers are warmed up, and that stream releases
+ * frames older than its history, so the pipeline pool never runs dry
+ *
+ * @param pool Frames to send in turn
+ * @return true If check passed
+ */
+bool CheckRetransmissions(const std::vector<pipeline::EncodedFramePtr> &pool) {
+  auto sink = std::make_unique<CountingSink>();
+  CountingSink &counting_sink = *sink;
+  const pipeline::StreamConfig config = {
+      1400, // bytes_per_packet
+      std::chrono::milliseconds(100), // frame_interval
+      0, // pacing_fraction
+      3, // max_queued_frames
+      kHistoryFrames, // history_frames
+      32 // max_retransmits_per_frame
+  };
+  pipeline::RtpStreamer streamer(config, std::make_shared<pipeline::FramePacketizer>(),
+                                 std::move(sink));
+
+  std::size_t measured_allocations = 0;
+  for (std::size_t i = 0; i < kWarmUpFrames + kMeasuredFrames; ++i) {
+    if (i == kWarmUpFrames) {
+      measured_allocations = allocations;
+    }
+
+    const pipeline::EncodedFramePtr &frame = pool[i % kPoolSize];
+    if (frame.use_count() != 1) {
+      std::cerr << "Frame is still referenced by the stream, when it's reused"
+                << std::endl;
+      return false;
+    }
+
+    if (i % kNackInterval == kNackInterval - 1) {
+      // Two packets of the previous frame and one before them
+      streamer.OnNack({streamer.GetSynchronizationSource(),
+                       static_cast<uint16_t>(counting_sink.last_sequence_number - 3),
+                       0b101});
+    }
+    streamer.OnFrame(frame);
+    streamer.Flush();
+  }
+  measured_allocations = allocations - measured_allocations;
+
+  std::cout << measured_allocations << " allocations in " << kMeasuredFrames
+            << " frames, " << counting_sink.packets << " packets, "
+            << streamer.GetRetransmittedPackets() << " retransmitted" << std::endl;
+  return measured_allocations == 0 && streamer.GetRetransmittedPackets() != 0;
+}
+
+/**
+ * @brief Check that paced sessions sharing the egress don't allocate, when
+ * their interleaved datagrams are sorted by send time on every flush
+ *
+ * @param pool Frames to send in turn
+ * @return true If check passed
+ */
+bool CheckPacedSessions(const std::vector<pipeline::EncodedFramePtr> &pool) {
+  const auto egress = std::make_shared<pipeline::RtpEgress>(
+      pipeline::RtpEgress::Config{false, 0, {"", 1}});
+  const pipeline::StreamConfig config = {
+      1400, // bytes_per_packet
+      std::chrono::milliseconds(2), // frame_interval
+      0.5, // pacing_fraction
+      3, // max_queued_frames
+      kHistoryFrames, // history_frames
+      32 // max_retransmits_per_frame
+  };
+  std::vector<std::unique_ptr<pipeline::RtpStreamer>> streamers;
+  for (std::size_t i = 0; i < kPacedSessions; ++i) {
+    streamers.push_back(std::make_unique<pipeline::RtpStreamer>(
+        config, std::make_shared<pipeline::FramePacketizer>(),
+        std::make_unique<pipeline::UdpSink>(
+            "127.0.0.1", kFirstClientPort + 2 * static_cast<int>(i), egress)));
+  }
+
+  std::size_t measured_allocations = 0;
+  for (std::size_t i = 0; i < kWarmUpFrames + kMeasuredFrames; ++i) {
+    if (i == kWarmUpFrames) {
+      measured_allocations = allocations;
+    }
+
+    const pipeline::EncodedFramePtr &frame = pool[i % kPoolSize];
+    for (const auto &streamer : streamers) {
+      streamer->OnFrame(frame);
+    }
+    for (const auto &streamer : streamers) {
+      streamer->Flush();
+    }
+  }
+  measured_allocations = allocations - measured_allocations;
+
+  std::cout << measured_allocations << " allocations in " << kMeasuredFrames
+            << " frames of " << kPacedSessions << " paced sessions" << std::endl;
+  return measured_allocations == 0;
+}
+
+} // namespace
+
+int main() {
+  // The largest frame goes first, so buffers are warmed up with it
+  std::vector<pipeline::EncodedFramePtr> pool;
+  for (std::size_t i = 0; i < kPoolSize; ++i) {
+    pool.push_back(BuildFrame(150'000 - i * 20'000));
+  }
+
+  if (!CheckRetransmissions(pool) || !CheckPacedSessions(pool)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}